@@ -1,45 +1,115 @@
 #ifndef DONUTVULKAN_ALLOCATOR_ARENA_H_
 #define DONUTVULKAN_ALLOCATOR_ARENA_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <new>
 
 namespace allocator {
 
+enum HugePageMode {
+  kHugePagesOff,
+  // madvise(MADV_HUGEPAGE) on blocks aligned to huge pages
+  kHugePagesTransparent,
+  // MAP_HUGETLB, kHugePagesTransparent when none are reserved or when
+  // reserving
+  kHugePagesExplicit,
+};
+
+struct ArenaConfig {
+  // the first block, rounded up to whole pages
+  size_t block_size = 4096;
+  // every new block is twice the previous one up to this, bigger
+  // allocations still get a block of their own
+  size_t max_block_size = 64 << 20;
+  HugePageMode huge_pages = kHugePagesOff;
+  // block sizes are rounded up to it when huge pages are on
+  size_t huge_page_size = 2 << 20;
+  /**
+   * when not 0 the arena reserves this much address space up front and
+   * commits it as allocations need it, in steps growing like blocks do.
+   * Allocations are then contiguous and past the reservation throw
+   */
+  size_t reserve_size = 0;
+};
+
 class Arena {
+  struct Block;
+
  public:
+  // a position in the arena, see Mark() and Rewind()
+  struct Marker {
+    Block* block = nullptr;
+    size_t size = 0;
+  };
+
   Arena();
+  explicit Arena(const ArenaConfig& config);
   ~Arena();
 
   Arena(const Arena&) = delete;
   Arena& operator=(const Arena&) = delete;
-  Arena(Arena&&) = default;
-  Arena& operator=(Arena&&) = default;
+  Arena(Arena&& other);
+  Arena& operator=(Arena&& other);
 
   template <typename T>
   auto Alloc() -> T* {
-    return reinterpret_cast<T*>(Alloc(sizeof(T)));
+    return static_cast<T*>(Alloc(sizeof(T), alignof(T)));
   }
   template <typename T>
-  auto Alloc(uint32_t count) -> T* {
-    return reinterpret_cast<T*>(Alloc(count * sizeof(T)));
+  auto Alloc(size_t count) -> T* {
+    if (count > SIZE_MAX / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(Alloc(count * sizeof(T), alignof(T)));
   }
-  auto Alloc(uint32_t size) -> void*;
+  // `alignment` has to be a power of two, it may be bigger than a page
+  auto Alloc(size_t size, size_t alignment = alignof(std::max_align_t))
+      -> void*;
+
+  auto Mark() const -> Marker;
+  /**
+   * frees everything allocated after `marker` was taken, the pages stay
+   * mapped and are handed out again by the next allocations
+   */
+  auto Rewind(Marker marker) -> void;
+  // Rewind to before the first allocation
+  auto Reset() -> void;
+
+  // bytes of every block mapped so far, or committed when reserving
+  auto MappedSize() const -> size_t { return mapped_size_; }
 
  private:
   struct Block {
     void* start = nullptr;
     Block* next = nullptr;
-    uint32_t page_count;
+    // mapped, or committed when reserving, including this header
+    size_t size;
   };
 
-  auto AllocatePages(uint32_t count) -> void;
-  auto LastBlockCapacity() const -> uint32_t;
+  // bumps `size_` in `current_`, nullptr when it doesn't fit there
+  auto TryAlloc(size_t size, size_t alignment) -> void*;
+  // maps a block for at least `size` bytes and links it after `current_`
+  auto AllocateBlock(size_t size) -> void;
+  // commits at least `size` bytes past `size_` of the reservation
+  auto Commit(size_t size) -> void;
+  auto MapBlock(size_t size, int prot, HugePageMode huge_pages) -> void*;
+  auto BlockCapacity(const Block* block) const -> size_t;
+  auto Granularity() const -> size_t;
+  auto ReservedSize() const -> size_t;
+  auto NextGrowth() -> size_t;
+  auto Release() -> void;
+
+  static auto PageSize() -> size_t;
 
-  auto PageSize() const -> uint32_t;
+  ArenaConfig config_;
+  size_t next_block_size_;
+  size_t mapped_size_ = 0;
 
   Block* start_ = nullptr;
-  Block* last_block_ = nullptr;
-  uint32_t size_ = 0;
+  // blocks after `current_` are mapped but free
+  Block* current_ = nullptr;
+  size_t size_ = 0;
 };
 
 }  // namespace allocator
@@ -0,0 +1,57 @@
+#ifndef DONUTVULKAN_ALLOCATOR_ARENA_RESOURCE_H_
+#define DONUTVULKAN_ALLOCATOR_ARENA_RESOURCE_H_
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+#include "allocator/arena.h"
+
+namespace allocator {
+
+/**
+ * std::pmr::memory_resource over an Arena, for standard containers.
+ * It is monotonic: deallocating does nothing and everything is freed at
+ * once by Release() or the destructor. Requests the arena can't satisfy,
+ * e.g. past ArenaConfig::reserve_size, go to `upstream` when there is one.
+ * Not thread safe, like Arena.
+ */
+class ArenaResource : public std::pmr::memory_resource {
+ public:
+  explicit ArenaResource(const ArenaConfig& config = {},
+                         std::pmr::memory_resource* upstream = nullptr);
+  ~ArenaResource() override;
+
+  ArenaResource(const ArenaResource&) = delete;
+  ArenaResource& operator=(const ArenaResource&) = delete;
+
+  // frees every allocation, the arena keeps its pages for the next ones
+  auto Release() -> void;
+
+  auto GetArena() -> Arena& { return arena_; }
+  auto Upstream() const -> std::pmr::memory_resource* { return upstream_; }
+  // bytes currently taken from `upstream`
+  auto UpstreamSize() const -> size_t { return upstream_size_; }
+
+ private:
+  struct UpstreamAllocation {
+    void* ptr;
+    size_t size;
+    size_t alignment;
+  };
+
+  auto do_allocate(size_t size, size_t alignment) -> void* override;
+  auto do_deallocate(void* ptr, size_t size, size_t alignment)
+      -> void override;
+  auto do_is_equal(const std::pmr::memory_resource& other) const noexcept
+      -> bool override;
+
+  Arena arena_;
+  std::pmr::memory_resource* upstream_;
+  std::vector<UpstreamAllocation> upstream_allocations_;
+  size_t upstream_size_ = 0;
+};
+
+}  // namespace allocator
+
+#endif  // DONUTVULKAN_ALLOCATOR_ARENA_RESOURCE_H_
@@ -0,0 +1,89 @@
+#ifndef DONUTVULKAN_ALLOCATOR_CONCURRENT_ARENA_H_
+#define DONUTVULKAN_ALLOCATOR_CONCURRENT_ARENA_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+namespace allocator {
+
+struct ConcurrentArenaConfig {
+  // what a thread bump-allocates from before it takes another chunk
+  size_t chunk_size = 64 << 10;
+  // chunks are cut from slabs this big, bigger requests get their own slab
+  size_t slab_size = 4 << 20;
+};
+
+/**
+ * Monotonic arena that any number of threads allocate from at once.
+ * Every thread bump-allocates from a chunk of its own with no atomics or
+ * locks; chunks are cut from shared slabs with an atomic add, and only
+ * mapping a new slab takes a lock. Requests over a quarter of a chunk skip
+ * the thread's chunk and are cut from the slab directly.
+ * Everything is freed at once when the arena is destroyed, which must not
+ * race with allocations.
+ */
+class ConcurrentArena {
+ public:
+  ConcurrentArena();
+  explicit ConcurrentArena(const ConcurrentArenaConfig& config);
+  ~ConcurrentArena();
+
+  ConcurrentArena(const ConcurrentArena&) = delete;
+  ConcurrentArena& operator=(const ConcurrentArena&) = delete;
+
+  template <typename T>
+  auto Alloc() -> T* {
+    return static_cast<T*>(Alloc(sizeof(T), alignof(T)));
+  }
+  template <typename T>
+  auto Alloc(size_t count) -> T* {
+    if (count > SIZE_MAX / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(Alloc(count * sizeof(T), alignof(T)));
+  }
+  // `alignment` has to be a power of two
+  auto Alloc(size_t size, size_t alignment = alignof(std::max_align_t))
+      -> void*;
+
+  // bytes of every slab mapped so far
+  auto MappedSize() const -> size_t {
+    return mapped_size_.load(std::memory_order_relaxed);
+  }
+  // chunks handed to threads so far
+  auto ChunkCount() const -> size_t {
+    return chunk_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Slab {
+    Slab* next;
+    size_t size;
+    std::atomic<size_t> used;
+  };
+
+  // `size` bytes aligned to a cache line cut from the current slab
+  auto TakeChunk(size_t size) -> uint8_t*;
+  // maps a slab for at least `size` bytes, `mutex_` has to be held
+  auto MapSlab(size_t size) -> Slab*;
+
+  ConcurrentArenaConfig config_;
+  // tells this arena's thread chunks from those of arenas that were at the
+  // same address before
+  uint64_t id_;
+
+  std::atomic<Slab*> current_ = nullptr;
+  std::atomic<size_t> mapped_size_ = 0;
+  std::atomic<size_t> chunk_count_ = 0;
+
+  // guards `slabs_` and replacing `current_`
+  std::mutex mutex_;
+  Slab* slabs_ = nullptr;
+};
+
+}  // namespace allocator
+
+#endif  // DONUTVULKAN_ALLOCATOR_CONCURRENT_ARENA_H_
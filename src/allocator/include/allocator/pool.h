@@ -0,0 +1,174 @@
+#ifndef DONUTVULKAN_ALLOCATOR_POOL_H_
+#define DONUTVULKAN_ALLOCATOR_POOL_H_
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+
+#include "allocator/arena.h"
+
+namespace allocator {
+
+struct PoolConfig {
+  // objects in the first slab, every new slab holds twice as many up to
+  // max_slab_objects
+  size_t slab_objects = 64;
+  size_t max_slab_objects = 64 << 10;
+  // free objects a PoolCache keeps before handing half of them back
+  size_t cache_size = 64;
+};
+
+/**
+ * Pool of fixed-size slots with an intrusive free list, slabs of slots are
+ * cut from an Arena. Alloc and Free are O(1) and thread safe behind a
+ * mutex; a PoolCache per thread avoids the mutex for most calls.
+ * Slots still in use when the pool is destroyed are freed with it.
+ */
+class FixedPool {
+ public:
+  FixedPool(size_t slot_size,
+            size_t slot_alignment,
+            const PoolConfig& config = {});
+
+  FixedPool(const FixedPool&) = delete;
+  FixedPool& operator=(const FixedPool&) = delete;
+
+  auto Alloc() -> void*;
+  auto Free(void* ptr) -> void;
+
+  auto SlotSize() const -> size_t { return slot_size_; }
+  // slots cut from slabs so far, in use or free
+  auto Capacity() const -> size_t;
+
+ private:
+  friend class PoolCache;
+
+  struct Node {
+    Node* next;
+  };
+
+  // pops up to `count` slots into a list, returns how many
+  auto TakeBatch(size_t count, Node*& head) -> size_t;
+  // pushes the list from `head` to `tail`
+  auto ReturnBatch(Node* head, Node* tail) -> void;
+  // a fresh slot from the current slab, `mutex_` has to be held
+  auto CarveSlot() -> Node*;
+
+  const size_t slot_size_;
+  const size_t slot_alignment_;
+  const PoolConfig config_;
+
+  mutable std::mutex mutex_;
+  Arena arena_;
+  Node* free_ = nullptr;
+  // unused part of the newest slab
+  char* slab_next_ = nullptr;
+  char* slab_end_ = nullptr;
+  size_t next_slab_objects_;
+  size_t capacity_ = 0;
+};
+
+/**
+ * Free slots of a FixedPool for one thread, Alloc and Free only lock the
+ * pool to move half a cache worth of slots at once. Gives its slots back
+ * to the pool when destroyed, so it can't outlive the pool.
+ */
+class PoolCache {
+ public:
+  explicit PoolCache(FixedPool& pool);
+  ~PoolCache();
+
+  PoolCache(const PoolCache&) = delete;
+  PoolCache& operator=(const PoolCache&) = delete;
+
+  auto Alloc() -> void* {
+    if (!head_) {
+      Refill();
+    }
+    FixedPool::Node* const node = head_;
+    head_ = node->next;
+    --count_;
+    return node;
+  }
+  auto Free(void* ptr) -> void {
+    FixedPool::Node* const node = static_cast<FixedPool::Node*>(ptr);
+    node->next = head_;
+    head_ = node;
+    if (++count_ > pool_.config_.cache_size) {
+      Drain(pool_.config_.cache_size / 2);
+    }
+  }
+
+ private:
+  auto Refill() -> void;
+  // hands all but `keep` slots back to the pool
+  auto Drain(size_t keep) -> void;
+
+  FixedPool& pool_;
+  FixedPool::Node* head_ = nullptr;
+  size_t count_ = 0;
+};
+
+/**
+ * FixedPool of T sized and aligned slots. Alloc and Free hand out raw
+ * storage, New and Delete construct and destroy in it.
+ */
+template <typename T>
+class Pool {
+ public:
+  // PoolCache of T
+  class Cache {
+   public:
+    explicit Cache(Pool& pool) : cache_(pool.pool_) {}
+
+    auto Alloc() -> T* { return static_cast<T*>(cache_.Alloc()); }
+    auto Free(T* ptr) -> void { cache_.Free(ptr); }
+    template <typename... Args>
+    auto New(Args&&... args) -> T* {
+      T* const ptr = Alloc();
+      try {
+        return new (ptr) T(std::forward<Args>(args)...);
+      } catch (...) {
+        Free(ptr);
+        throw;
+      }
+    }
+    auto Delete(T* ptr) -> void {
+      ptr->~T();
+      Free(ptr);
+    }
+
+   private:
+    PoolCache cache_;
+  };
+
+  explicit Pool(const PoolConfig& config = {})
+      : pool_(sizeof(T), alignof(T), config) {}
+
+  auto Alloc() -> T* { return static_cast<T*>(pool_.Alloc()); }
+  auto Free(T* ptr) -> void { pool_.Free(ptr); }
+  template <typename... Args>
+  auto New(Args&&... args) -> T* {
+    T* const ptr = Alloc();
+    try {
+      return new (ptr) T(std::forward<Args>(args)...);
+    } catch (...) {
+      Free(ptr);
+      throw;
+    }
+  }
+  auto Delete(T* ptr) -> void {
+    ptr->~T();
+    Free(ptr);
+  }
+
+  auto Capacity() const -> size_t { return pool_.Capacity(); }
+
+ private:
+  FixedPool pool_;
+};
+
+}  // namespace allocator
+
+#endif  // DONUTVULKAN_ALLOCATOR_POOL_H_
@@ -2,91 +2,259 @@
 
 #include <sys/mman.h>
 #include <unistd.h>
+#include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <new>
+#include <utility>
 
 namespace allocator {
 
-Arena::Arena() {}
+namespace {
+
+// keeps every size computed from a request from overflowing, nothing this
+// big could be mapped anyway
+constexpr size_t kMaxRequestSize = SIZE_MAX / 4;
+
+auto RoundUp(size_t value, size_t multiple) -> size_t {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+}  // namespace
+
+Arena::Arena() : Arena(ArenaConfig{}) {}
+
+Arena::Arena(const ArenaConfig& config)
+    : config_(config), next_block_size_(config.block_size) {}
 
 Arena::~Arena() {
-  Block* cur_block = start_;
-  const uint32_t page_size = PageSize();
+  Release();
+}
+
+Arena::Arena(Arena&& other)
+    : config_(other.config_),
+      next_block_size_(std::exchange(other.next_block_size_,
+                                     other.config_.block_size)),
+      mapped_size_(std::exchange(other.mapped_size_, 0)),
+      start_(std::exchange(other.start_, nullptr)),
+      current_(std::exchange(other.current_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
 
-  while (cur_block->next) {
-    Block* const prev_block = cur_block;
-    cur_block = cur_block->next;
-    munmap(prev_block, prev_block->page_count * page_size);
+Arena& Arena::operator=(Arena&& other) {
+  if (this != &other) {
+    Release();
+    config_ = other.config_;
+    next_block_size_ =
+        std::exchange(other.next_block_size_, other.config_.block_size);
+    mapped_size_ = std::exchange(other.mapped_size_, 0);
+    start_ = std::exchange(other.start_, nullptr);
+    current_ = std::exchange(other.current_, nullptr);
+    size_ = std::exchange(other.size_, 0);
   }
-  munmap(cur_block, cur_block->page_count * page_size);
+  return *this;
 }
 
-auto Arena::Alloc(uint32_t size) -> void* {
+auto Arena::Alloc(size_t size, size_t alignment) -> void* {
+  assert(std::has_single_bit(alignment));
   if (size == 0) {
     return nullptr;
   }
+  if (size > kMaxRequestSize || alignment > kMaxRequestSize) {
+    throw std::bad_alloc();
+  }
 
-  if (LastBlockCapacity() - size_ >= size) {
-    if (!last_block_) {
-      AllocatePages(1);
+  if (current_) {
+    if (void* const location = TryAlloc(size, alignment)) {
+      return location;
     }
-    void* const location =
-        reinterpret_cast<uint8_t*>(last_block_->start) + size_;
-    size_ += size;
-    return location;
-  } else {
-    const uint32_t page_size = PageSize();
-    const uint32_t needed_pages_raw = size / page_size;
-    const uint32_t needed_pages =
-        needed_pages_raw * page_size - sizeof(Block) < size
-            ? needed_pages_raw + 1
-            : needed_pages_raw;
+  }
 
-    AllocatePages(needed_pages);
-    size_ = size;
-    return last_block_->start;
+  // enough for `size` wherever the alignment padding ends up
+  const size_t padded_size = size + alignment - 1;
+  if (config_.reserve_size) {
+    Commit(padded_size);
+    return TryAlloc(size, alignment);
   }
-}
 
-auto Arena::AllocatePages(uint32_t count) -> void {
-  if (count == 0) {
-    return;
+  Block* const next = current_ ? current_->next : start_;
+  if (next && BlockCapacity(next) >= padded_size) {
+    current_ = next;
+    size_ = 0;
+  } else {
+    AllocateBlock(padded_size);
   }
+  return TryAlloc(size, alignment);
+}
 
-  const uint32_t page_size = PageSize();
-  void* addr =
-      last_block_ ? last_block_ + page_size * last_block_->page_count : nullptr;
-  void* const block_start =
-      mmap(addr, page_size * count, PROT_READ | PROT_WRITE,
-           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-  if (block_start == MAP_FAILED) {
-    throw std::bad_alloc();
+auto Arena::Mark() const -> Marker {
+  return Marker{.block = current_, .size = size_};
+}
+
+auto Arena::Rewind(Marker marker) -> void {
+  // a reservation is one block that is always current
+  current_ = marker.block || !config_.reserve_size ? marker.block : start_;
+  size_ = marker.size;
+}
+
+auto Arena::Reset() -> void {
+  Rewind(Marker{});
+}
+
+auto Arena::TryAlloc(size_t size, size_t alignment) -> void* {
+  const uintptr_t start = reinterpret_cast<uintptr_t>(current_->start);
+  const uintptr_t location = (start + size_ + alignment - 1) & ~(alignment - 1);
+  if (location + size > start + BlockCapacity(current_)) {
+    return nullptr;
   }
 
-  *reinterpret_cast<Block*>(block_start) = Block{
-      .start = reinterpret_cast<Block*>(block_start) + 1,
-      .next = nullptr,
-      .page_count = count,
+  size_ = location + size - start;
+  return reinterpret_cast<void*>(location);
+}
+
+auto Arena::AllocateBlock(size_t size) -> void {
+  const size_t block_size =
+      RoundUp(std::max(size + sizeof(Block), NextGrowth()), Granularity());
+
+  Block* const block = reinterpret_cast<Block*>(
+      MapBlock(block_size, PROT_READ | PROT_WRITE, config_.huge_pages));
+  *block = Block{
+      .start = block + 1,
+      .next = current_ ? current_->next : start_,
+      .size = block_size,
   };
+  mapped_size_ += block_size;
 
-  if (last_block_) {
-    last_block_->next = reinterpret_cast<Block*>(block_start);
+  if (current_) {
+    current_->next = block;
   } else {
-    start_ = reinterpret_cast<Block*>(block_start);
+    start_ = block;
   }
-  last_block_ = reinterpret_cast<Block*>(block_start);
+  current_ = block;
   size_ = 0;
 }
 
-auto Arena::PageSize() const -> uint32_t {
-  return sysconf(_SC_PAGESIZE);
+auto Arena::Commit(size_t size) -> void {
+  const size_t reserved = ReservedSize();
+  const size_t committed = start_ ? start_->size : 0;
+  const size_t needed = sizeof(Block) + size_ + size;
+  if (needed > reserved) {
+    throw std::bad_alloc();
+  }
+  const size_t target = std::min(
+      reserved,
+      RoundUp(std::max(needed, committed + NextGrowth()), Granularity()));
+
+  // MAP_HUGETLB pages can't be committed lazily
+  const HugePageMode huge_pages = config_.huge_pages == kHugePagesOff
+                                      ? kHugePagesOff
+                                      : kHugePagesTransparent;
+  uint8_t* const base =
+      start_ ? reinterpret_cast<uint8_t*>(start_)
+             : static_cast<uint8_t*>(MapBlock(reserved, PROT_NONE, huge_pages));
+  if (mprotect(base + committed, target - committed, PROT_READ | PROT_WRITE)) {
+    if (!start_) {
+      munmap(base, reserved);
+    }
+    throw std::bad_alloc();
+  }
+
+  if (!start_) {
+    start_ = reinterpret_cast<Block*>(base);
+    *start_ = Block{.start = start_ + 1, .next = nullptr, .size = 0};
+    current_ = start_;
+    size_ = 0;
+  }
+  start_->size = target;
+  mapped_size_ = target;
+}
+
+auto Arena::MapBlock(size_t size, int prot, HugePageMode huge_pages)
+    -> void* {
+  constexpr int kFlags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+  switch (huge_pages) {
+    case kHugePagesOff: {
+      // right after the current block if the kernel agrees
+      void* const addr =
+          current_ ? reinterpret_cast<uint8_t*>(current_) + current_->size
+                   : nullptr;
+      void* const block = mmap(addr, size, prot, kFlags, -1, 0);
+      if (block == MAP_FAILED) {
+        throw std::bad_alloc();
+      }
+      return block;
+    }
+    case kHugePagesExplicit: {
+      void* const block =
+          mmap(nullptr, size, prot, kFlags | MAP_HUGETLB, -1, 0);
+      if (block != MAP_FAILED) {
+        return block;
+      }
+      // no huge pages reserved
+      [[fallthrough]];
+    }
+    case kHugePagesTransparent:
+      break;
+  }
+
+  // over-map and trim so the block starts on a huge page, only whole
+  // aligned huge pages can be backed by one
+  const size_t huge_page_size = config_.huge_page_size;
+  void* const mapping =
+      mmap(nullptr, size + huge_page_size, prot, kFlags, -1, 0);
+  if (mapping == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+  uint8_t* const begin = static_cast<uint8_t*>(mapping);
+  uint8_t* const block = reinterpret_cast<uint8_t*>(
+      RoundUp(reinterpret_cast<uintptr_t>(begin), huge_page_size));
+  if (block != begin) {
+    munmap(begin, block - begin);
+  }
+  munmap(block + size, begin + huge_page_size - block);
+  // fails harmlessly without transparent huge pages
+  madvise(block, size, MADV_HUGEPAGE);
+  return block;
+}
+
+auto Arena::BlockCapacity(const Block* block) const -> size_t {
+  return block->size - sizeof(Block);
+}
+
+auto Arena::Granularity() const -> size_t {
+  return config_.huge_pages == kHugePagesOff ? PageSize()
+                                             : config_.huge_page_size;
+}
+
+auto Arena::ReservedSize() const -> size_t {
+  return RoundUp(config_.reserve_size, Granularity());
+}
+
+auto Arena::NextGrowth() -> size_t {
+  const size_t growth = next_block_size_;
+  if (next_block_size_ < config_.max_block_size) {
+    next_block_size_ =
+        std::min(next_block_size_, config_.max_block_size / 2) * 2;
+  }
+  return growth;
+}
+
+auto Arena::Release() -> void {
+  while (start_) {
+    Block* const block = start_;
+    start_ = block->next;
+    munmap(block, config_.reserve_size ? ReservedSize() : block->size);
+  }
+  current_ = nullptr;
+  size_ = 0;
+  mapped_size_ = 0;
 }
 
-auto Arena::LastBlockCapacity() const -> uint32_t {
-  const auto page_size = PageSize();
-  return last_block_ ? page_size * last_block_->page_count - sizeof(Block)
-                     : page_size - sizeof(Block);
+auto Arena::PageSize() -> size_t {
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  return page_size;
 }
 
 }  // namespace allocator
@@ -0,0 +1,57 @@
+#include "allocator/arena_resource.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+
+#include "allocator/arena.h"
+
+namespace allocator {
+
+ArenaResource::ArenaResource(const ArenaConfig& config,
+                             std::pmr::memory_resource* upstream)
+    : arena_(config), upstream_(upstream) {}
+
+ArenaResource::~ArenaResource() {
+  Release();
+}
+
+auto ArenaResource::Release() -> void {
+  for (const UpstreamAllocation& allocation : upstream_allocations_) {
+    upstream_->deallocate(allocation.ptr, allocation.size,
+                          allocation.alignment);
+  }
+  upstream_allocations_.clear();
+  upstream_size_ = 0;
+  arena_.Reset();
+}
+
+auto ArenaResource::do_allocate(size_t size, size_t alignment) -> void* {
+  // memory_resource hands out a distinct pointer even for 0 bytes
+  size = std::max<size_t>(size, 1);
+  try {
+    return arena_.Alloc(size, alignment);
+  } catch (const std::bad_alloc&) {
+    if (!upstream_) {
+      throw;
+    }
+  }
+
+  // can't fail once the upstream memory is taken
+  upstream_allocations_.reserve(upstream_allocations_.size() + 1);
+  void* const ptr = upstream_->allocate(size, alignment);
+  upstream_allocations_.push_back(
+      UpstreamAllocation{.ptr = ptr, .size = size, .alignment = alignment});
+  upstream_size_ += size;
+  return ptr;
+}
+
+auto ArenaResource::do_deallocate(void*, size_t, size_t) -> void {}
+
+auto ArenaResource::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept -> bool {
+  return this == &other;
+}
+
+}  // namespace allocator
@@ -0,0 +1,165 @@
+#include "allocator/concurrent_arena.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+namespace allocator {
+
+namespace {
+
+// chunks and slab headers are cache line aligned so that threads don't
+// share lines
+constexpr size_t kChunkAlignment = 64;
+constexpr int kThreadChunkSlots = 4;
+// keeps every size computed from a request from overflowing
+constexpr size_t kMaxRequestSize = SIZE_MAX / 4;
+
+struct ThreadChunk {
+  uint64_t arena_id = 0;
+  uintptr_t next = 0;
+  uintptr_t end = 0;
+};
+
+// the chunks of the last few arenas the thread allocated from
+thread_local ThreadChunk t_chunks[kThreadChunkSlots];
+thread_local int t_next_victim = 0;
+
+std::atomic<uint64_t> g_next_arena_id = 1;
+
+auto RoundUp(size_t value, size_t multiple) -> size_t {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+auto AlignUp(uintptr_t address, size_t alignment) -> uintptr_t {
+  return (address + alignment - 1) & ~(alignment - 1);
+}
+
+auto PageSize() -> size_t {
+  static const size_t page_size = sysconf(_SC_PAGESIZE);
+  return page_size;
+}
+
+auto FindChunk(uint64_t arena_id) -> ThreadChunk& {
+  for (ThreadChunk& chunk : t_chunks) {
+    if (chunk.arena_id == arena_id) {
+      return chunk;
+    }
+  }
+
+  // what was left of the evicted chunk is lost until the arena goes away
+  ThreadChunk& chunk = t_chunks[t_next_victim];
+  t_next_victim = (t_next_victim + 1) % kThreadChunkSlots;
+  chunk = ThreadChunk{.arena_id = arena_id};
+  return chunk;
+}
+
+}  // namespace
+
+ConcurrentArena::ConcurrentArena()
+    : ConcurrentArena(ConcurrentArenaConfig{}) {}
+
+ConcurrentArena::ConcurrentArena(const ConcurrentArenaConfig& config)
+    : config_(config),
+      id_(g_next_arena_id.fetch_add(1, std::memory_order_relaxed)) {
+  config_.chunk_size = RoundUp(std::max(config_.chunk_size, kChunkAlignment),
+                               kChunkAlignment);
+  config_.slab_size =
+      std::max(config_.slab_size, config_.chunk_size + kChunkAlignment);
+}
+
+ConcurrentArena::~ConcurrentArena() {
+  while (slabs_) {
+    Slab* const slab = slabs_;
+    slabs_ = slab->next;
+    munmap(slab, slab->size);
+  }
+}
+
+auto ConcurrentArena::Alloc(size_t size, size_t alignment) -> void* {
+  assert(std::has_single_bit(alignment));
+  if (size == 0) {
+    return nullptr;
+  }
+  if (size > kMaxRequestSize || alignment > kMaxRequestSize) {
+    throw std::bad_alloc();
+  }
+
+  ThreadChunk& chunk = FindChunk(id_);
+  uintptr_t location = AlignUp(chunk.next, alignment);
+  if (location + size <= chunk.end) {
+    chunk.next = location + size;
+    return reinterpret_cast<void*>(location);
+  }
+
+  // enough for `size` wherever the alignment padding ends up
+  const size_t padded_size = size + alignment - 1;
+  if (padded_size > config_.chunk_size / 4) {
+    const uintptr_t start = reinterpret_cast<uintptr_t>(
+        TakeChunk(RoundUp(padded_size, kChunkAlignment)));
+    return reinterpret_cast<void*>(AlignUp(start, alignment));
+  }
+
+  const uintptr_t start =
+      reinterpret_cast<uintptr_t>(TakeChunk(config_.chunk_size));
+  chunk_count_.fetch_add(1, std::memory_order_relaxed);
+  location = AlignUp(start, alignment);
+  chunk.next = location + size;
+  chunk.end = start + config_.chunk_size;
+  return reinterpret_cast<void*>(location);
+}
+
+auto ConcurrentArena::TakeChunk(size_t size) -> uint8_t* {
+  if (size > config_.slab_size / 4) {
+    std::lock_guard lock(mutex_);
+    Slab* const slab = MapSlab(size + kChunkAlignment);
+    slab->used.store(slab->size, std::memory_order_relaxed);
+    return reinterpret_cast<uint8_t*>(slab) + kChunkAlignment;
+  }
+
+  for (;;) {
+    Slab* const slab = current_.load(std::memory_order_acquire);
+    if (slab) {
+      // overshooting a full slab is harmless, nobody cuts from it again
+      const size_t offset =
+          slab->used.fetch_add(size, std::memory_order_relaxed);
+      if (offset <= slab->size - size) {
+        return reinterpret_cast<uint8_t*>(slab) + offset;
+      }
+    }
+
+    std::lock_guard lock(mutex_);
+    // another thread may have replaced it while this one waited
+    if (current_.load(std::memory_order_relaxed) == slab) {
+      current_.store(MapSlab(config_.slab_size), std::memory_order_release);
+    }
+  }
+}
+
+auto ConcurrentArena::MapSlab(size_t size) -> Slab* {
+  const size_t slab_size = RoundUp(size, PageSize());
+  void* const mapping = mmap(nullptr, slab_size, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED) {
+    throw std::bad_alloc();
+  }
+
+  Slab* const slab = new (mapping) Slab{
+      .next = slabs_,
+      .size = slab_size,
+      .used = kChunkAlignment,
+  };
+  static_assert(sizeof(Slab) <= kChunkAlignment);
+  slabs_ = slab;
+  mapped_size_.fetch_add(slab_size, std::memory_order_relaxed);
+  return slab;
+}
+
+}  // namespace allocator
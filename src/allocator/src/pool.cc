@@ -0,0 +1,127 @@
+#include "allocator/pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+namespace allocator {
+
+namespace {
+
+auto RoundUp(size_t value, size_t multiple) -> size_t {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+}  // namespace
+
+FixedPool::FixedPool(size_t slot_size,
+                     size_t slot_alignment,
+                     const PoolConfig& config)
+    : slot_size_(RoundUp(std::max(slot_size, sizeof(Node)),
+                         std::max(slot_alignment, alignof(Node)))),
+      slot_alignment_(std::max(slot_alignment, alignof(Node))),
+      config_(config),
+      next_slab_objects_(std::max<size_t>(config.slab_objects, 1)) {}
+
+auto FixedPool::Alloc() -> void* {
+  std::lock_guard lock(mutex_);
+  if (Node* const node = free_) {
+    free_ = node->next;
+    return node;
+  }
+  return CarveSlot();
+}
+
+auto FixedPool::Free(void* ptr) -> void {
+  Node* const node = static_cast<Node*>(ptr);
+  std::lock_guard lock(mutex_);
+  node->next = free_;
+  free_ = node;
+}
+
+auto FixedPool::Capacity() const -> size_t {
+  std::lock_guard lock(mutex_);
+  return capacity_;
+}
+
+auto FixedPool::TakeBatch(size_t count, Node*& head) -> size_t {
+  std::lock_guard lock(mutex_);
+  for (size_t i = 0; i < count; ++i) {
+    Node* node = free_;
+    if (node) {
+      free_ = node->next;
+    } else {
+      node = CarveSlot();
+    }
+    node->next = head;
+    head = node;
+  }
+  return count;
+}
+
+auto FixedPool::ReturnBatch(Node* head, Node* tail) -> void {
+  std::lock_guard lock(mutex_);
+  tail->next = free_;
+  free_ = head;
+}
+
+auto FixedPool::CarveSlot() -> Node* {
+  if (slab_next_ == slab_end_) {
+    const size_t objects = next_slab_objects_;
+    if (objects > SIZE_MAX / slot_size_) {
+      throw std::bad_alloc();
+    }
+    if (next_slab_objects_ < config_.max_slab_objects) {
+      next_slab_objects_ =
+          std::min(next_slab_objects_, config_.max_slab_objects / 2) * 2;
+    }
+
+    slab_next_ =
+        static_cast<char*>(arena_.Alloc(objects * slot_size_, slot_alignment_));
+    slab_end_ = slab_next_ + objects * slot_size_;
+  }
+
+  Node* const node = reinterpret_cast<Node*>(slab_next_);
+  slab_next_ += slot_size_;
+  ++capacity_;
+  return node;
+}
+
+PoolCache::PoolCache(FixedPool& pool) : pool_(pool) {}
+
+PoolCache::~PoolCache() {
+  Drain(0);
+}
+
+auto PoolCache::Refill() -> void {
+  count_ += pool_.TakeBatch(std::max<size_t>(pool_.config_.cache_size / 2, 1),
+                            head_);
+}
+
+auto PoolCache::Drain(size_t keep) -> void {
+  FixedPool::Node* kept_tail = nullptr;
+  FixedPool::Node* head = head_;
+  for (size_t i = 0; i < keep && head; ++i) {
+    kept_tail = head;
+    head = head->next;
+  }
+  if (!head) {
+    return;
+  }
+
+  FixedPool::Node* tail = head;
+  while (tail->next) {
+    tail = tail->next;
+  }
+  if (kept_tail) {
+    kept_tail->next = nullptr;
+  } else {
+    head_ = nullptr;
+  }
+  pool_.ReturnBatch(head, tail);
+  count_ = keep;
+}
+
+}  // namespace allocator
@@ -0,0 +1,86 @@
+#include <cstdint>
+#include <iostream>
+
+#include "allocator/arena.h"
+#include "allocator/concurrent_arena.h"
+#include "allocator/pool.h"
+#include "bench/harness.h"
+
+namespace {
+
+// a cache line, about a frame or job descriptor
+struct Object {
+  uint64_t words[8];
+};
+
+// objects alive at once in the churn benchmarks
+constexpr int kLive = 64;
+
+template <typename Alloc, typename Free>
+void Churn(int64_t iterations, Alloc&& alloc, Free&& free) {
+  Object* live[kLive];
+  for (int64_t i = 0; i < iterations; i += kLive) {
+    for (Object*& object : live) {
+      object = alloc();
+      object->words[0] = i;
+    }
+    bench::KeepAlive(live);
+    for (Object* object : live) {
+      free(object);
+    }
+  }
+}
+
+void BenchChurn(bench::Suite& suite) {
+  suite.Run("churn/new_delete", [](int64_t iterations) {
+    Churn(
+        iterations, [] { return new Object; },
+        [](Object* object) { delete object; });
+  });
+
+  allocator::Pool<Object> pool;
+  suite.Run("churn/pool", [&](int64_t iterations) {
+    Churn(
+        iterations, [&] { return pool.Alloc(); },
+        [&](Object* object) { pool.Free(object); });
+  });
+  suite.Run("churn/pool_cache", [&](int64_t iterations) {
+    allocator::Pool<Object>::Cache cache(pool);
+    Churn(
+        iterations, [&] { return cache.Alloc(); },
+        [&](Object* object) { cache.Free(object); });
+  });
+
+  // monotonic, freed all at once
+  allocator::Arena arena;
+  suite.Run("churn/arena_rewind", [&](int64_t iterations) {
+    const allocator::Arena::Marker marker = arena.Mark();
+    Churn(
+        iterations, [&] { return arena.Alloc<Object>(); },
+        [&](Object*) { arena.Rewind(marker); });
+  });
+  allocator::ConcurrentArena concurrent_arena;
+  suite.Run("alloc/concurrent_arena", [&](int64_t iterations) {
+    for (int64_t i = 0; i < iterations; ++i) {
+      bench::KeepAlive(concurrent_arena.Alloc<Object>());
+    }
+  });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  bench::SuiteConfig config;
+  if (!bench::Suite::ParseArgs(argc, argv, config)) {
+    std::cerr << "usage: " << argv[0]
+              << " [--warmup=N] [--repetitions=N] [--min-time-ms=N]"
+                 " [--filter=SUBSTRING] [--format=table|json|csv]"
+              << std::endl;
+    return 1;
+  }
+  bench::Suite suite(config);
+
+  BenchChurn(suite);
+
+  suite.Print(std::cout);
+}
@@ -4,8 +4,19 @@
 
 #include <sys/mman.h>
 #include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "allocator/arena.h"
+#include "allocator/arena_resource.h"
+#include "allocator/concurrent_arena.h"
+#include "allocator/pool.h"
 
 using namespace allocator;
 
@@ -72,3 +83,422 @@ TEST_CASE("Allocating half a page and then entire page") {
   CHECK_EQ(mincore(Align(p1), kPageSize * kExpectedPages1, vec1), 0);
   CHECK_EQ(mincore(Align(p2), kPageSize * kExpectedPages2, vec2), 0);
 }
+
+TEST_CASE("Allocations are aligned") {
+  struct alignas(64) Line {
+    unsigned char bytes[64];
+  };
+  Arena a;
+
+  auto* c = a.Alloc<char>();
+  auto* d = a.Alloc<double>();
+  auto* c2 = a.Alloc<char>(3);
+  auto* line = a.Alloc<Line>();
+  auto* raw = a.Alloc(1);
+  auto* wide = a.Alloc(1, 256);
+  auto* huge = a.Alloc(1, kPageSize * 2);
+
+  CHECK_NE(c, nullptr);
+  CHECK_EQ(reinterpret_cast<uintptr_t>(d) % alignof(double), 0);
+  CHECK_GT(reinterpret_cast<uintptr_t>(c2), reinterpret_cast<uintptr_t>(d));
+  CHECK_EQ(reinterpret_cast<uintptr_t>(line) % 64, 0);
+  CHECK_EQ(reinterpret_cast<uintptr_t>(raw) % alignof(std::max_align_t), 0);
+  CHECK_EQ(reinterpret_cast<uintptr_t>(wide) % 256, 0);
+  CHECK_EQ(reinterpret_cast<uintptr_t>(huge) % (kPageSize * 2), 0);
+}
+
+TEST_CASE("Rewinding reuses memory") {
+  Arena a;
+
+  auto* first = a.Alloc<int>();
+  const Arena::Marker marker = a.Mark();
+  auto* second = a.Alloc<int>(16);
+  // spills into a second block
+  a.Alloc(kPageSize);
+
+  a.Rewind(marker);
+  CHECK_EQ(a.Alloc<int>(16), second);
+
+  a.Reset();
+  CHECK_EQ(a.Alloc<int>(), first);
+}
+
+TEST_CASE("Rewound blocks stay mapped and are reused") {
+  Arena a;
+  unsigned char vec;
+
+  a.Alloc(kPageSize / 2);
+  auto* spilled = a.Alloc(kPageSize / 2 + kPageSize / 4);
+  a.Reset();
+
+  CHECK_EQ(mincore(Align(spilled), kPageSize, &vec), 0);
+  a.Alloc(kPageSize / 2);
+  CHECK_EQ(a.Alloc(kPageSize / 2 + kPageSize / 4), spilled);
+
+  // too big for the free block, gets a new one in front of it
+  a.Reset();
+  a.Alloc(kPageSize / 2);
+  auto* big = a.Alloc(kPageSize * 3 + kPageSize / 2);
+  CHECK_NE(big, spilled);
+  CHECK_EQ(a.Alloc(kPageSize / 2 + kPageSize / 4), spilled);
+}
+
+TEST_CASE("Moving an arena moves its blocks") {
+  Arena a;
+  unsigned char vec;
+  auto* p = a.Alloc<int>();
+
+  {
+    Arena b(std::move(a));
+    CHECK_EQ(mincore(Align(p), kPageSize, &vec), 0);
+    a = std::move(b);
+  }
+
+  CHECK_EQ(mincore(Align(p), kPageSize, &vec), 0);
+  CHECK_NE(a.Alloc<int>(), p);
+}
+
+TEST_CASE("Blocks grow geometrically up to the cap") {
+  Arena a(ArenaConfig{
+      .block_size = static_cast<size_t>(kPageSize),
+      .max_block_size = static_cast<size_t>(kPageSize * 8),
+  });
+
+  std::vector<size_t> block_sizes;
+  size_t mapped = 0;
+  while (block_sizes.size() < 6) {
+    a.Alloc(256);
+    if (a.MappedSize() != mapped) {
+      block_sizes.push_back((a.MappedSize() - mapped) / kPageSize);
+      mapped = a.MappedSize();
+    }
+  }
+  const std::vector<size_t> expected = {1, 2, 4, 8, 8, 8};
+  CHECK(block_sizes == expected);
+
+  // bigger than the cap still fits in one block
+  auto* big = static_cast<unsigned char*>(a.Alloc(kPageSize * 20));
+  CHECK_EQ(a.MappedSize() - mapped, static_cast<size_t>(kPageSize) * 21);
+  big[kPageSize * 20 - 1] = 1;
+}
+
+TEST_CASE("Huge page blocks") {
+  for (const HugePageMode mode : {kHugePagesTransparent, kHugePagesExplicit}) {
+    Arena a(ArenaConfig{.huge_pages = mode});
+    const size_t huge_page_size = ArenaConfig{}.huge_page_size;
+
+    auto* p = a.Alloc<uint64_t>(1024);
+    CHECK_EQ(reinterpret_cast<uintptr_t>(p) / huge_page_size *
+                 huge_page_size,
+             reinterpret_cast<uintptr_t>(p) & ~(kPageSize - 1));
+    CHECK_EQ(a.MappedSize(), huge_page_size);
+    p[1023] = 1;
+
+    auto* q = a.Alloc<unsigned char>(huge_page_size * 2);
+    CHECK_EQ(a.MappedSize() % huge_page_size, 0u);
+    q[huge_page_size * 2 - 1] = 1;
+  }
+}
+
+TEST_CASE("Reserved arenas commit on demand and stay contiguous") {
+  Arena a(ArenaConfig{
+      .block_size = static_cast<size_t>(kPageSize),
+      .reserve_size = static_cast<size_t>(kPageSize) * 1024,
+  });
+  unsigned char vec;
+
+  auto* first = a.Alloc<uint64_t>(16);
+  CHECK_EQ(a.MappedSize(), (size_t)kPageSize);
+  // committed pages only, the rest is reserved
+  CHECK_EQ(mincore(Align(first), kPageSize, &vec), 0);
+
+  uint64_t* last = first + 15;
+  for (int i = 0; i < 100; ++i) {
+    auto* p = a.Alloc<uint64_t>(kPageSize / sizeof(uint64_t) / 2);
+    CHECK_EQ(p, last + 1);
+    p[kPageSize / sizeof(uint64_t) / 2 - 1] = i;
+    last = p + kPageSize / sizeof(uint64_t) / 2 - 1;
+  }
+  CHECK_LT(a.MappedSize(), (size_t)kPageSize * 128);
+
+  a.Reset();
+  const size_t committed = a.MappedSize();
+  CHECK_EQ(a.Alloc<uint64_t>(16), first);
+  CHECK_EQ(a.MappedSize(), committed);
+
+  CHECK_THROWS_AS(a.Alloc(kPageSize * 1024), std::bad_alloc);
+  // a failed allocation leaves the arena as it was
+  CHECK_EQ(a.Alloc<uint64_t>(), first + 16);
+}
+
+TEST_CASE("Oversized requests throw instead of overflowing") {
+  Arena a;
+
+  CHECK_THROWS_AS(a.Alloc<uint64_t>(SIZE_MAX / 4), std::bad_alloc);
+  CHECK_THROWS_AS(a.Alloc(SIZE_MAX - 8), std::bad_alloc);
+  CHECK_EQ(a.MappedSize(), 0u);
+}
+
+TEST_CASE("Blocks can be bigger than 4 GiB") {
+  Arena a(ArenaConfig{.reserve_size = size_t{5} << 30});
+
+  auto* p = a.Alloc<unsigned char>(size_t{4} << 30);
+  auto* q = a.Alloc<unsigned char>(1);
+  CHECK_EQ(q, p + (size_t{4} << 30));
+}
+
+namespace {
+
+// counts what goes through it to the heap
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t allocated = 0;
+  size_t deallocated = 0;
+
+ private:
+  auto do_allocate(size_t size, size_t alignment) -> void* override {
+    allocated += size;
+    return std::pmr::new_delete_resource()->allocate(size, alignment);
+  }
+  auto do_deallocate(void* ptr, size_t size, size_t alignment)
+      -> void override {
+    deallocated += size;
+    std::pmr::new_delete_resource()->deallocate(ptr, size, alignment);
+  }
+  auto do_is_equal(const std::pmr::memory_resource& other) const noexcept
+      -> bool override {
+    return this == &other;
+  }
+};
+
+}  // namespace
+
+TEST_CASE("ArenaResource backs pmr containers") {
+  ArenaResource resource;
+
+  std::pmr::vector<int> ints(&resource);
+  for (int i = 0; i < 10000; ++i) {
+    ints.push_back(i);
+  }
+  const size_t mapped = resource.GetArena().MappedSize();
+  CHECK_GE(mapped, 10000 * sizeof(int));
+
+  struct alignas(64) Line {
+    unsigned char bytes[64];
+  };
+  std::pmr::vector<Line> lines(3, &resource);
+  CHECK_EQ(reinterpret_cast<uintptr_t>(lines.data()) % 64, 0u);
+
+  CHECK(resource.is_equal(resource));
+  ArenaResource other;
+  CHECK_FALSE(resource.is_equal(other));
+
+  // monotonic, the freed vector isn't reused until Release()
+  ints = std::pmr::vector<int>(&resource);
+  void* const next = resource.allocate(sizeof(int));
+  CHECK_NE(next, nullptr);
+  CHECK_NE(resource.allocate(0), resource.allocate(0));
+}
+
+TEST_CASE("ArenaResource falls back to its upstream") {
+  CountingResource upstream;
+  {
+    ArenaResource resource(
+        ArenaConfig{.reserve_size = static_cast<size_t>(kPageSize) * 4},
+        &upstream);
+
+    void* const in_arena = resource.allocate(kPageSize);
+    CHECK_EQ(upstream.allocated, 0u);
+    void* const spilled = resource.allocate(kPageSize * 8);
+    CHECK_NE(spilled, nullptr);
+    CHECK_EQ(upstream.allocated, (size_t)kPageSize * 8);
+    CHECK_EQ(resource.UpstreamSize(), (size_t)kPageSize * 8);
+
+    resource.deallocate(spilled, kPageSize * 8);
+    CHECK_EQ(upstream.deallocated, 0u);
+
+    resource.Release();
+    CHECK_EQ(upstream.deallocated, (size_t)kPageSize * 8);
+    CHECK_EQ(resource.allocate(kPageSize), in_arena);
+
+    CHECK_NE(resource.allocate(kPageSize * 8), nullptr);
+  }
+  CHECK_EQ(upstream.deallocated, (size_t)kPageSize * 16);
+
+  ArenaResource bounded(
+      ArenaConfig{.reserve_size = static_cast<size_t>(kPageSize)});
+  CHECK_THROWS_AS(bounded.allocate(kPageSize * 2), std::bad_alloc);
+}
+
+TEST_CASE("ConcurrentArena threads allocate disjoint memory") {
+  constexpr int kThreads = 8;
+  constexpr int kAllocations = 20000;
+  ConcurrentArena a(ConcurrentArenaConfig{
+      .chunk_size = 4096,
+      .slab_size = 64 << 10,
+  });
+
+  std::vector<std::vector<uint32_t*>> allocations(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kAllocations; ++i) {
+        // mostly small, now and then past a chunk or a slab
+        const size_t count = i % 1000 == 999 ? 5000 : i % 7 + 1;
+        auto* p = a.Alloc<uint32_t>(count);
+        std::fill(p, p + count, (uint32_t)(t * kAllocations + i));
+        allocations[t].push_back(p);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (int t = 0; t < kThreads; ++t) {
+    for (int i = 0; i < kAllocations; ++i) {
+      const size_t count = i % 1000 == 999 ? 5000 : i % 7 + 1;
+      uint32_t* const p = allocations[t][i];
+      REQUIRE_EQ(reinterpret_cast<uintptr_t>(p) % alignof(uint32_t), 0u);
+      CHECK(std::all_of(p, p + count, [&](uint32_t value) {
+        return value == (uint32_t)(t * kAllocations + i);
+      }));
+    }
+  }
+}
+
+TEST_CASE("ConcurrentArena threads keep to their chunks") {
+  ConcurrentArena a(ConcurrentArenaConfig{.chunk_size = 4096});
+
+  auto* first = a.Alloc<uint64_t>();
+  for (int i = 0; i < 100; ++i) {
+    auto* p = a.Alloc<uint64_t>();
+    CHECK_EQ(p, first + i + 1);
+  }
+  CHECK_EQ(a.ChunkCount(), 1u);
+
+  std::thread([&] { a.Alloc<uint64_t>(); }).join();
+  CHECK_EQ(a.ChunkCount(), 2u);
+
+  // interleaving arenas on one thread keeps both chunks
+  ConcurrentArena b;
+  auto* in_b = b.Alloc<uint64_t>();
+  CHECK_EQ(a.Alloc<uint64_t>(), first + 101);
+  CHECK_EQ(b.Alloc<uint64_t>(), in_b + 1);
+  CHECK_EQ(a.ChunkCount(), 2u);
+
+  struct alignas(128) Wide {
+    unsigned char bytes[128];
+  };
+  CHECK_EQ(reinterpret_cast<uintptr_t>(a.Alloc<Wide>()) % 128, 0u);
+  auto* big = a.Alloc<unsigned char>(a.MappedSize() * 2);
+  big[a.MappedSize() / 2] = 1;
+}
+
+TEST_CASE("ConcurrentArena destruction frees every slab") {
+  unsigned char vec;
+  void* p;
+  void* big;
+  {
+    ConcurrentArena a;
+    p = a.Alloc<int>();
+    big = a.Alloc(8 << 20);
+    CHECK_EQ(mincore(Align(p), kPageSize, &vec), 0);
+  }
+
+  CHECK_EQ(mincore(Align(p), kPageSize, &vec), -1);
+  CHECK_EQ(mincore(Align(big), kPageSize, &vec), -1);
+}
+
+TEST_CASE("Pool reuses freed objects") {
+  struct alignas(32) Job {
+    int id;
+    double payload[3];
+  };
+  Pool<Job> pool(PoolConfig{.slab_objects = 4});
+
+  std::vector<Job*> jobs;
+  for (int i = 0; i < 10; ++i) {
+    jobs.push_back(pool.New(Job{.id = i, .payload = {}}));
+    CHECK_EQ(reinterpret_cast<uintptr_t>(jobs.back()) % alignof(Job), 0u);
+  }
+  // slabs of 4 and 8
+  CHECK_EQ(pool.Capacity(), 10u);
+  for (int i = 0; i < 10; ++i) {
+    CHECK_EQ(jobs[i]->id, i);
+  }
+
+  pool.Delete(jobs[3]);
+  pool.Delete(jobs[7]);
+  CHECK_EQ(pool.Alloc(), jobs[7]);
+  CHECK_EQ(pool.Alloc(), jobs[3]);
+  pool.Alloc();
+  pool.Alloc();
+  pool.Alloc();
+  CHECK_EQ(pool.Capacity(), 13u);
+}
+
+TEST_CASE("Pool caches move slots in batches") {
+  Pool<uint64_t> pool(PoolConfig{.cache_size = 8});
+  std::vector<uint64_t*> slots;
+  {
+    Pool<uint64_t>::Cache cache(pool);
+    for (int i = 0; i < 20; ++i) {
+      slots.push_back(cache.New(i));
+    }
+    // refills of 4
+    CHECK_EQ(pool.Capacity(), 20u);
+    for (uint64_t* slot : slots) {
+      cache.Delete(slot);
+    }
+    uint64_t* const reused = cache.Alloc();
+    CHECK_EQ(reused, slots.back());
+    cache.Free(reused);
+  }
+
+  // the cache gave everything back
+  for (int i = 0; i < 20; ++i) {
+    pool.Alloc();
+  }
+  CHECK_EQ(pool.Capacity(), 20u);
+}
+
+TEST_CASE("Pool caches on many threads") {
+  constexpr int kThreads = 8;
+  constexpr int kRounds = 2000;
+  Pool<std::pair<int, int>> pool(PoolConfig{.cache_size = 16});
+
+  std::vector<std::thread> threads;
+  std::atomic<int> corrupted = 0;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      Pool<std::pair<int, int>>::Cache cache(pool);
+      std::vector<std::pair<int, int>*> live;
+      for (int i = 0; i < kRounds; ++i) {
+        live.push_back(cache.New(t, i));
+        // frees from other threads' slabs too, through the pool
+        if (i % 3 == 2) {
+          for (std::pair<int, int>* pair : live) {
+            corrupted += pair->first != t;
+            cache.Delete(pair);
+          }
+          live.clear();
+        }
+      }
+      for (std::pair<int, int>* pair : live) {
+        pool.Delete(pair);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  CHECK_EQ(corrupted.load(), 0);
+  // nothing leaked: every slot is back and is handed out again
+  const size_t capacity = pool.Capacity();
+  for (size_t i = 0; i < capacity; ++i) {
+    pool.Alloc();
+  }
+  CHECK_EQ(pool.Capacity(), capacity);
+}
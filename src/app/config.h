@@ -1,12 +1,36 @@
 #ifndef DONUTCPP_APP_CONFIG_H_
 #define DONUTCPP_APP_CONFIG_H_
 
+#include <cstddef>
+
+#include "core/shade_kernel.h"
 #include "core/vec3.h"
+#include "core/vulkan_renderer.h"
 
 namespace config {
 inline const int kWindowWidth = 800;
 inline const int kWindowHeight = 600;
 inline const int kTargetFps = 24;
+// 0 means one thread per hardware thread
+inline const int kRasterThreads = 0;
+// kFramebufferPacked lets raster threads skip the merge pass,
+// kFramebufferEpoch makes the per-frame clear O(1)
+inline const core::FramebufferMode kFramebufferMode = core::kFramebufferDepth;
+// kPresentThread overlaps the terminal write with rendering the next frame
+inline const core::PresentMode kPresentMode = core::kPresentThread;
+// per stage frame time percentiles are written there on exit and on
+// SIGUSR1, nullptr disables it
+inline const char* const kFrameStatsPath = nullptr;
+
+// with RendererOptions::frame_cache: the donut animation repeats every 10π
+// of its angle, the frames of this many evenly spaced angles in that period
+// are cached and the animation snaps to them. 302 is about one step per
+// frame at kTargetFps, so the second loop of the animation is all cache hits
+inline const int kFrameCacheSteps = 302;
+inline const std::size_t kFrameCacheBytes = std::size_t{64} << 20;
+
+// precision of the object points, double halves the transform throughput
+using Real = float;
 
 inline const int kCubeSidePresicion = 100;
 inline const double kCubeSideSize = 0.5;
@@ -19,6 +43,12 @@ inline const char kLightLevles[] = ".,-_:;=+*#%@";
 inline const int kLightLevelCount = sizeof(kLightLevles) / sizeof(char) - 1;
 inline const core::Vec3 kLightPoint =
     core::Vec3({-1.0, -1.0, 3.0}).Normalized();
+// kLightingObjectSpace rotates the light once instead of every normal
+inline const core::LightingMode kLightingMode = core::kLightingObjectSpace;
+// skips the depth test of points facing away, the object must be closed.
+// Lossy on sparse point clouds: back faces show through the gaps between
+// front face points, the donut at kDonutPrecision loses cells every frame
+inline const bool kCullBackFaces = false;
 }  // namespace config
 
 #endif  // DONUTCPP_APP_CONFIG_H_
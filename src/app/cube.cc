@@ -1,21 +1,25 @@
 #include "cube.h"
 
+#include <memory_resource>
 #include <numbers>
 
 #include "core/point_info.h"
 #include "core/rotation.h"
 #include "core/vec3.h"
 
-Cube::Cube(double side_size, int precision)
-    : Object(), side_size_(side_size), precision_(precision) {
-  points_.resize(precision * precision * 6);
-  const double step = side_size_ / precision_;
+template <typename T>
+CubeT<T>::CubeT(T side_size, int precision, std::pmr::memory_resource* resource)
+    : core::ObjectT<T>(resource),
+      side_size_(side_size),
+      precision_(precision) {
+  this->points_.Resize(precision * precision * 6);
+  const T step = side_size_ / precision_;
 
   struct Transition {
-    core::Vec3 move;
-    core::Vec3 rotate;
-    core::Vec3 normal;
-    double angle;
+    core::Vec3T<T> move;
+    core::Vec3T<T> rotate;
+    core::Vec3T<T> normal;
+    T angle;
   };
 
   Transition face_transitions[6] = {
@@ -29,13 +33,13 @@ Cube::Cube(double side_size, int precision)
           .move = {0.0, 0.0, 0.0},
           .rotate = {0.0, 1.0, 0.0},
           .normal = {-1.0, 0.0, 0.0},
-          .angle = -std::numbers::pi / 2.0,
+          .angle = -std::numbers::pi_v<T> / 2,
       },
       Transition{
           .move = {0.0, 0.0, 0.0},
           .rotate = {1.0, 0.0, 0.0},
           .normal = {0.0, -1.0, 0.0},
-          .angle = std::numbers::pi / 2.0,
+          .angle = std::numbers::pi_v<T> / 2,
       },
       Transition{
           .move = {0.0, 0.0, side_size_},
@@ -47,35 +51,38 @@ Cube::Cube(double side_size, int precision)
           .move = {side_size_, 0.0, 0.0},
           .rotate = {0.0, 1.0, 0.0},
           .normal = {1.0, 0.0, 0.0},
-          .angle = -std::numbers::pi / 2.0,
+          .angle = -std::numbers::pi_v<T> / 2,
       },
       Transition{
           .move = {0.0, side_size_, 0.0},
           .rotate = {1.0, 0.0, 0.0},
           .normal = {0.0, 1.0, 0.0},
-          .angle = std::numbers::pi / 2.0,
+          .angle = std::numbers::pi_v<T> / 2,
       },
   };
 
   for (int side = 0; side < 6; ++side) {
     const Transition& cur_trans = face_transitions[side];
-    const core::Vec3& axis = cur_trans.rotate;
-    const core::Vec3& move = cur_trans.move;
-    const core::Vec3& normal = cur_trans.normal;
+    const core::Vec3T<T>& axis = cur_trans.rotate;
+    const core::Vec3T<T>& move = cur_trans.move;
+    const core::Vec3T<T>& normal = cur_trans.normal;
 
     for (int i = 0; i < precision_; ++i) {
       for (int j = 0; j < precision_; ++j) {
         const int ind = side * precision_ * precision_ + j * precision_ + i;
 
-        double x = step * i;
-        double y = step * j;
+        T x = step * i;
+        T y = step * j;
 
-        core::Vec3 out =
-            core::Rotate(core::Vec3{x, y, 0.0}, axis, cur_trans.angle);
+        core::Vec3T<T> out =
+            core::Rotate(core::Vec3T<T>{x, y, 0}, axis, cur_trans.angle);
         out += move;
 
-        points_[ind] = core::PointInfo{.p = out, .normal = normal};
+        this->points_.Set(ind, core::PointInfoT<T>{.p = out, .normal = normal});
       }
     }
   }
 }
+
+template class CubeT<float>;
+template class CubeT<double>;
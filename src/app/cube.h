@@ -1,15 +1,26 @@
 #ifndef DONUTCPP_APP_CUBE_H_
 #define DONUTCPP_APP_CUBE_H_
 
+#include <memory_resource>
+
 #include "core/object.h"
 
-class Cube : public core::Object {
+template <typename T>
+class CubeT : public core::ObjectT<T> {
  public:
-  Cube(double side_size, int precision);
+  CubeT(T side_size,
+        int precision,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
  private:
-  double side_size_;
+  T side_size_;
   int precision_;
 };
 
+extern template class CubeT<float>;
+extern template class CubeT<double>;
+
+using Cube = CubeT<double>;
+using Cubef = CubeT<float>;
+
 #endif  // DONUTCPP_APP_CUBE_H_
@@ -1,6 +1,8 @@
 #ifndef DONUTCPP_APP_DONUT_H_
 #define DONUTCPP_APP_DONUT_H_
 
+#include <memory_resource>
+
 #include "core/object.h"
 
 /**
@@ -10,10 +12,21 @@
  *  @param precision amount of points along the minor and circles along the
  * major radiuses
  */
-class Donut : public core::Object {
+template <typename T>
+class DonutT : public core::ObjectT<T> {
  public:
-  Donut() = default;
-  Donut(double r1, double r2, int precision);
+  DonutT() = default;
+  DonutT(T r1,
+         T r2,
+         int precision,
+         std::pmr::memory_resource* resource =
+             std::pmr::get_default_resource());
 };
 
+extern template class DonutT<float>;
+extern template class DonutT<double>;
+
+using Donut = DonutT<double>;
+using Donutf = DonutT<float>;
+
 #endif  // DONUTCPP_APP_DONUT_H_
@@ -1,12 +1,145 @@
 #include "renderer.h"
 
+#include <charconv>
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <string_view>
 
+#include "core/frame_recorder.h"
+#include "core/frame_sink.h"
 #include "core/result.h"
+#include "core/vulkan_renderer.h"
 
-int main() {
-  auto rend_exp = Renderer::New();
+#include "config.h"
+
+namespace {
+
+struct Args {
+  // 0 runs the interactive window
+  int64_t batch_frames = 0;
+  // raw frames back to back, batch runs only
+  const char* output_path = nullptr;
+  const char* record_path = nullptr;
+  core::RecordFormat record_format = core::kRecordRawDelta;
+  // interactive runs only, batches measure the rasterizer
+  bool frame_cache = false;
+};
+
+bool ParseArgs(int argc, char** argv, Args& args) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    const std::string_view value = arg.substr(arg.find('=') + 1);
+
+    if (arg.starts_with("--batch=")) {
+      const auto [end, error] = std::from_chars(
+          value.data(), value.data() + value.size(), args.batch_frames);
+      if (error != std::errc() || end != value.data() + value.size() ||
+          args.batch_frames <= 0) {
+        return false;
+      }
+    } else if (arg == "--frame-cache") {
+      args.frame_cache = true;
+    } else if (arg.starts_with("--output=")) {
+      args.output_path = value.data();
+    } else if (arg.starts_with("--record=")) {
+      args.record_path = value.data();
+    } else if (arg == "--record-format=raw") {
+      args.record_format = core::kRecordRaw;
+    } else if (arg == "--record-format=delta") {
+      args.record_format = core::kRecordRawDelta;
+    } else if (arg == "--record-format=asciicast") {
+      args.record_format = core::kRecordAsciicast;
+    } else {
+      return false;
+    }
+  }
+  // a batch has one sink
+  return (!args.output_path || (args.batch_frames && !args.record_path)) &&
+         !(args.frame_cache && args.batch_frames);
+}
+
+/**
+ * renders `args.batch_frames` frames headless as fast as possible into
+ * `recorder`, `args.output_path` or nowhere and prints the throughput
+ */
+int RunBatch(const Args& args, core::FrameSink* recorder) {
+  auto rend_exp = Renderer::New({.backend = core::kBackendHeadless});
+  if (!rend_exp) {
+    std::cerr << core::ResultToString(rend_exp.error()) << std::endl;
+    return 1;
+  }
+  std::unique_ptr<Renderer> rend(*rend_exp);
+
+  core::NullSink null_sink;
+  core::FrameSink* sink = recorder ? recorder : &null_sink;
+  std::unique_ptr<core::FileSink> file_sink;
+  if (args.output_path) {
+    auto sink_exp = core::FileSink::New(args.output_path);
+    if (!sink_exp) {
+      std::cerr << core::ResultToString(sink_exp.error()) << std::endl;
+      return 1;
+    }
+    file_sink.reset(*sink_exp);
+    sink = file_sink.get();
+  }
+
+  const auto report = rend->RenderBatch({
+      .frames = args.batch_frames,
+      .delta = 1.0 / config::kTargetFps,
+      .sink = sink,
+  });
+  if (!report) {
+    std::cerr << core::ResultToString(report.error()) << std::endl;
+    return 1;
+  }
+
+  std::cout << "frames: " << report->frames << "\n"
+            << "seconds: " << report->elapsed.count() / 1e9 << "\n"
+            << "frames per second: " << report->FramesPerSecond() << "\n"
+            << "ns per point: " << report->NsPerPoint() << std::endl;
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  Args args;
+  if (!ParseArgs(argc, argv, args)) {
+    std::cerr << "usage: " << argv[0]
+              << " [--batch=FRAMES [--output=FILE] | --frame-cache]"
+                 " [--record=FILE [--record-format=raw|delta|asciicast]]"
+              << std::endl;
+    return 1;
+  }
+
+  std::unique_ptr<core::FrameRecorder> recorder;
+  if (args.record_path) {
+    auto recorder_exp = core::FrameRecorder::New(
+        args.record_path,
+        {
+            .width = config::kWindowWidth,
+            .height = config::kWindowHeight,
+            .format = args.record_format,
+            // batch frames are evenly spaced in simulated time
+            .frame_interval =
+                args.batch_frames ? 1.0 / config::kTargetFps : 0.0,
+        });
+    if (!recorder_exp) {
+      std::cerr << core::ResultToString(recorder_exp.error()) << std::endl;
+      return 1;
+    }
+    recorder.reset(*recorder_exp);
+  }
+
+  if (args.batch_frames) {
+    return RunBatch(args, recorder.get());
+  }
+
+  auto rend_exp = Renderer::New({
+      .recorder = recorder.get(),
+      .frame_cache = args.frame_cache,
+  });
   if (!rend_exp) {
     std::cerr << core::ResultToString(rend_exp.error()) << std::endl;
 
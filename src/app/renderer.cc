@@ -1,66 +1,133 @@
 #include "renderer.h"
 
-#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <expected>
 #include <memory>
+#include <numbers>
 
-#include "core/point_info.h"
+#include "core/epoch_framebuffer.h"
+#include "core/frame_cache.h"
+#include "core/frame_stats.h"
+#include "core/framebuffer.h"
+#include "core/packed_framebuffer.h"
+#include "core/parallel_raster.h"
 #include "core/result.h"
 #include "core/rotation.h"
+#include "core/shade_kernel.h"
 #include "core/vec3.h"
 #include "core/vulkan_renderer.h"
 
 #include "config.h"
 
-std::expected<Renderer*, core::Result> Renderer::New() {
+std::expected<Renderer*, core::Result> Renderer::New(
+    const RendererOptions& options) {
   std::unique_ptr<Renderer> rend(new Renderer);
 
   core::VulkanRendererConfig config{
       .width = config::kWindowWidth,
       .height = config::kWindowHeight,
-      .target_fps = config::kTargetFps,
+      .target_fps = options.target_fps,
+      .max_frames = options.max_frames,
+      .backend = options.backend,
+      .frame_stats_path = config::kFrameStatsPath,
+      .recorder = options.recorder,
+      .framebuffer_mode = config::kFramebufferMode,
+      .present_mode = options.present_mode,
       .render_handler = rend.get(),
+      .memory_resource = &rend->arena_,
   };
 
   rend->renderer_.reset(UNWRAP(core::VulkanRenderer::New(config)));
-  rend->donut_ = Donut(config::kDonutMajorR, config::kDonutMinorR,
-                       config::kDonutPrecision);
   rend->angle_ = 0.0;
+  rend->use_frame_cache_ = options.frame_cache;
+  rend->frame_cache_.SetBudget(config::kFrameCacheBytes);
+  rend->rasterizer_ =
+      std::make_unique<core::ParallelRasterizer>(config::kRasterThreads);
 
   return rend.release();
 }
 
+Renderer::Renderer()
+    : donut_(config::kDonutMajorR,
+             config::kDonutMinorR,
+             config::kDonutPrecision,
+             &arena_) {}
+
 void Renderer::Start() {
   renderer_->Start();
 }
 
+std::expected<core::BatchReport, core::Result> Renderer::RenderBatch(
+    const core::BatchConfig& config) {
+  return renderer_->RenderBatch(config);
+}
+
 void Renderer::Render(double delta, core::VulkanRenderer& renderer) {
   angle_ += 2.5 * delta;
 
-  for (const core::PointInfo& pi : donut_.Points()) {
-    const core::Vec3 rotate_axis1{0.1, 0.2, 0.5};
-    const core::Vec3 rotate_axis2{0.7, 0.7, -0.5};
-    core::Vec3 p = pi.p;
-
-    p = core::Rotate(p, rotate_axis1, angle_);
-    p = core::Rotate(p, rotate_axis2, angle_ * 0.2);
-    p += core::Vec3{0.5, 0.5, 0.5};  // move it to the center of the screen
-    p.x /= renderer.GetRatio();
-
-    core::Vec3 normal = pi.normal;
-    normal = core::Rotate(normal, rotate_axis1, angle_);
-    normal = core::Rotate(normal, rotate_axis2, angle_ * 0.2);
-
-    double dot = std::max(config::kLightPoint.Dot(normal),
-                          0.0);  // clamp to zero if negative
-    dot = std::min(dot, 1.0);
-    int light_index = (int)(dot * config::kLightLevelCount);
-    if (light_index > config::kLightLevelCount - 1) {
-      light_index = config::kLightLevelCount - 1;
+  double angle = angle_;
+  uint64_t cache_key = 0;
+  if (use_frame_cache_) {
+    // both rotations are whole turns again after 10π
+    const double period = 10.0 * std::numbers::pi;
+    const double step = period / config::kFrameCacheSteps;
+    cache_key = std::llround(std::fmod(angle_, period) / step) %
+                config::kFrameCacheSteps;
+    angle = cache_key * step;
+
+    const bool hit = frame_cache_.Visit(
+        cache_key, [&](int index, int length, char sym) {
+          if (sym != ' ') {
+            renderer.PutRun(index, length, 1.0, sym);
+          }
+        });
+    if (hit) {
+      last_points_ = 0;
+      return;
     }
+  }
 
-    char c = config::kLightLevles[light_index];
+  const core::Vec3 rotate_axis1{0.1, 0.2, 0.5};
+  const core::Vec3 rotate_axis2{0.7, 0.7, -0.5};
+  const core::Rotation rotation =
+      core::Rotation(rotate_axis1, angle)
+          .Then(core::Rotation(rotate_axis2, angle * 0.2));
 
-    renderer.Put(p, c);
+  const core::ShadeParams params{
+      .matrix = rotation.Matrix(),
+      // move it to the center of the screen
+      .offset = rotation.Offset() + core::Vec3{0.5, 0.5, 0.5},
+      .aspect_ratio = renderer.GetRatio(),
+      .light = config::kLightPoint,
+      .light_level_count = config::kLightLevelCount,
+      .width = renderer.GetWidth(),
+      .height = renderer.GetHeight(),
+      .lighting = config::kLightingMode,
+      .cull_back_faces = config::kCullBackFaces,
+  };
+  renderer.BeginStage(core::kStageRaster);
+  switch (renderer.GetFramebufferMode()) {
+    case core::kFramebufferDepth:
+      rasterizer_->Rasterize(donut_.Points(), params, config::kLightLevles,
+                             renderer.GetFramebuffer());
+      break;
+    case core::kFramebufferPacked:
+      rasterizer_->Rasterize(donut_.Points(), params, config::kLightLevles,
+                             renderer.GetPackedFramebuffer());
+      break;
+    case core::kFramebufferEpoch:
+      rasterizer_->Rasterize(donut_.Points(), params, config::kLightLevles,
+                             renderer.GetEpochFramebuffer());
+      break;
+  }
+  last_points_ = rasterizer_->LastCounters().points;
+
+  if (use_frame_cache_) {
+    frame_cache_.Insert(cache_key, renderer.ResolveChars());
   }
 }
+
+int64_t Renderer::LastPointCount() const {
+  return last_points_;
+}
@@ -1,29 +1,64 @@
 #ifndef DONUTCPP_APP_RENDERER_H_
 #define DONUTCPP_APP_RENDERER_H_
 
+#include <cstdint>
 #include <expected>
 #include <memory>
 
+#include "allocator/arena_resource.h"
+#include "core/frame_cache.h"
+#include "core/parallel_raster.h"
 #include "core/result.h"
 #include "core/vulkan_renderer.h"
+#include "config.h"
 #include "donut.h"
 
+// what Renderer::New may change from config.h, e.g. to run on a server
+struct RendererOptions {
+  core::BackendMode backend = core::kBackendVulkan;
+  core::PresentMode present_mode = config::kPresentMode;
+  int target_fps = config::kTargetFps;
+  // 0 means until the window is closed
+  int64_t max_frames = 0;
+  // gets every presented frame, e.g. a core::FrameRecorder
+  core::FrameSink* recorder = nullptr;
+  // replays cached frames of quantized angles, see config::kFrameCacheSteps;
+  // off for throughput measurements, hits skip the rasterizer
+  bool frame_cache = false;
+};
+
 class Renderer : core::VulkanRenderHandler {
  public:
   virtual ~Renderer() = default;
-  static std::expected<Renderer*, core::Result> New();
+  static std::expected<Renderer*, core::Result> New(
+      const RendererOptions& options = {});
 
   void Start();
+  // renders frames back to back at a fixed delta, see VulkanRenderer
+  std::expected<core::BatchReport, core::Result> RenderBatch(
+      const core::BatchConfig& config);
+  inline const core::FrameCacheStats& CacheStats() const {
+    return frame_cache_.Stats();
+  }
 
  protected:
   void Render(double delta, core::VulkanRenderer& renderer) override;
+  int64_t LastPointCount() const override;
 
  private:
-  Renderer() {};
+  Renderer();
 
+  // the donut and the framebuffer, freed after everything that uses them
+  allocator::ArenaResource arena_;
   std::unique_ptr<core::VulkanRenderer> renderer_;
-  Donut donut_;
+  std::unique_ptr<core::ParallelRasterizer> rasterizer_;
+  DonutT<config::Real> donut_;
   double angle_;
+  bool use_frame_cache_ = false;
+  // finished frames by quantized angle_
+  core::FrameCache frame_cache_;
+  // 0 when the last frame came from frame_cache_
+  int64_t last_points_ = 0;
 };
 
 #endif  // DONUTCPP_APP_RENDERER_H_
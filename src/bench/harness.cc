@@ -0,0 +1,162 @@
+#include "harness.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+namespace {
+
+int64_t TimeNs(const std::function<void(int64_t)>& body, int64_t iterations) {
+  const auto before = std::chrono::steady_clock::now();
+  body(iterations);
+  const auto after = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(after - before)
+      .count();
+}
+
+// nearest-rank percentile of sorted `values`
+double Percentile(const std::vector<double>& values, int percent) {
+  const std::size_t rank = (values.size() * percent + 99) / 100;
+  return values[std::max<std::size_t>(rank, 1) - 1];
+}
+
+bool ParseInt(std::string_view text, int64_t& value) {
+  const auto [end, error] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  return error == std::errc() && end == text.data() + text.size();
+}
+
+void PrintTableRow(std::ostream& out, const BenchResult& r) {
+  out << std::left << std::setw(40) << r.name << std::right << std::fixed
+      << std::setprecision(1) << " median " << std::setw(14) << r.median_ns
+      << " ns  p99 " << std::setw(14) << r.p99_ns << " ns  ("
+      << r.repetitions << " x " << r.iterations << ")\n";
+}
+
+}  // namespace
+
+Suite::Suite(const SuiteConfig& config) : cfg_(config) {}
+
+bool Suite::ParseArgs(int argc, char** argv, SuiteConfig& config) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    const std::size_t eq = arg.find('=');
+    const std::string_view key = arg.substr(0, eq);
+    const std::string_view value =
+        eq == std::string_view::npos ? "" : arg.substr(eq + 1);
+    int64_t number = 0;
+
+    if (key == "--warmup" && ParseInt(value, number) && number >= 0) {
+      config.warmup = number;
+    } else if (key == "--repetitions" && ParseInt(value, number) &&
+               number > 0) {
+      config.repetitions = number;
+    } else if (key == "--min-time-ms" && ParseInt(value, number) &&
+               number >= 0) {
+      config.min_repetition_ns = number * 1'000'000;
+    } else if (key == "--filter") {
+      config.filter = value;
+    } else if (key == "--format" && value == "table") {
+      config.format = kOutputTable;
+    } else if (key == "--format" && value == "json") {
+      config.format = kOutputJson;
+    } else if (key == "--format" && value == "csv") {
+      config.format = kOutputCsv;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Suite::Run(std::string_view name,
+                const std::function<void(int64_t iterations)>& body) {
+  if (name.find(cfg_.filter) == std::string_view::npos) {
+    return;
+  }
+
+  // calibration doubles as the first warmup
+  int64_t iterations = 1;
+  while (TimeNs(body, iterations) < cfg_.min_repetition_ns &&
+         iterations < (int64_t{1} << 40)) {
+    iterations *= 2;
+  }
+  for (int i = 0; i < cfg_.warmup; ++i) {
+    TimeNs(body, iterations);
+  }
+
+  std::vector<double> per_iteration(cfg_.repetitions);
+  for (double& ns : per_iteration) {
+    ns = TimeNs(body, iterations) / (double)iterations;
+  }
+  std::ranges::sort(per_iteration);
+
+  results_.push_back(BenchResult{
+      .name = std::string(name),
+      .iterations = iterations,
+      .repetitions = cfg_.repetitions,
+      .min_ns = per_iteration.front(),
+      .median_ns = Percentile(per_iteration, 50),
+      .p99_ns = Percentile(per_iteration, 99),
+      .mean_ns = std::reduce(per_iteration.begin(), per_iteration.end()) /
+                 per_iteration.size(),
+  });
+  if (cfg_.format == kOutputTable) {
+    PrintTableRow(std::cout, results_.back());
+  }
+}
+
+void Suite::Print(std::ostream& out) const {
+  switch (cfg_.format) {
+    case kOutputTable:
+      break;
+    case kOutputJson:
+      PrintJson(out);
+      break;
+    case kOutputCsv:
+      PrintCsv(out);
+      break;
+  }
+}
+
+void Suite::PrintJson(std::ostream& out) const {
+#ifdef NDEBUG
+  const char* build = "release";
+#else
+  const char* build = "debug";
+#endif
+  out << "{\"build\": \"" << build << "\", \"benchmarks\": [";
+  for (std::size_t i = 0; i < results_.size(); ++i) {
+    const BenchResult& r = results_[i];
+    // names are ours, nothing in them needs escaping
+    out << (i ? ",\n  " : "\n  ") << std::fixed << std::setprecision(2)
+        << "{\"name\": \"" << r.name << "\", \"iterations\": " << r.iterations
+        << ", \"repetitions\": " << r.repetitions
+        << ", \"min_ns\": " << r.min_ns << ", \"median_ns\": " << r.median_ns
+        << ", \"p99_ns\": " << r.p99_ns << ", \"mean_ns\": " << r.mean_ns
+        << "}";
+  }
+  out << "\n]}\n";
+}
+
+void Suite::PrintCsv(std::ostream& out) const {
+  out << "name,iterations,repetitions,min_ns,median_ns,p99_ns,mean_ns\n";
+  for (const BenchResult& r : results_) {
+    out << std::fixed << std::setprecision(2) << r.name << ','
+        << r.iterations << ',' << r.repetitions << ',' << r.min_ns << ','
+        << r.median_ns << ',' << r.p99_ns << ',' << r.mean_ns << '\n';
+  }
+}
+
+}  // namespace bench
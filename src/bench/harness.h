@@ -0,0 +1,78 @@
+#ifndef DONUTCPP_BENCH_HARNESS_H_
+#define DONUTCPP_BENCH_HARNESS_H_
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench {
+
+// keeps the compiler from dropping the computation of `value`
+template <typename T>
+inline void KeepAlive(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+enum OutputFormat {
+  kOutputTable = 0,
+  kOutputJson,
+  kOutputCsv,
+};
+
+struct SuiteConfig {
+  // untimed repetitions before the timed ones
+  int warmup = 3;
+  int repetitions = 30;
+  // iterations per repetition are doubled until a repetition takes this long
+  int64_t min_repetition_ns = 2'000'000;
+  // only benchmarks whose name contains it are run
+  std::string filter;
+  OutputFormat format = kOutputTable;
+};
+
+// times are per iteration
+struct BenchResult {
+  std::string name;
+  int64_t iterations = 0;
+  int repetitions = 0;
+  double min_ns = 0.0;
+  double median_ns = 0.0;
+  double p99_ns = 0.0;
+  double mean_ns = 0.0;
+};
+
+/**
+ * Runs benchmark bodies in timed repetitions and reports the per-iteration
+ * median and p99 over the repetitions.
+ * A body gets the iteration count and runs its measured work that many
+ * times, so the loop itself costs nothing per call.
+ */
+class Suite {
+ public:
+  explicit Suite(const SuiteConfig& config);
+
+  // parses --warmup=, --repetitions=, --min-time-ms=, --filter= and
+  // --format=table|json|csv, false on an unknown argument
+  static bool ParseArgs(int argc, char** argv, SuiteConfig& config);
+
+  void Run(std::string_view name,
+           const std::function<void(int64_t iterations)>& body);
+
+  const std::vector<BenchResult>& Results() const { return results_; }
+  // json and csv are printed at the end, table rows as they finish
+  void Print(std::ostream& out) const;
+
+ private:
+  void PrintJson(std::ostream& out) const;
+  void PrintCsv(std::ostream& out) const;
+
+  SuiteConfig cfg_;
+  std::vector<BenchResult> results_;
+};
+
+}  // namespace bench
+
+#endif  // DONUTCPP_BENCH_HARNESS_H_
@@ -0,0 +1,237 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "app/config.h"
+#include "app/cube.h"
+#include "app/donut.h"
+#include "app/renderer.h"
+#include "core/framebuffer.h"
+#include "core/parallel_raster.h"
+#include "core/presenter.h"
+#include "core/quaternion.h"
+#include "core/rotation.h"
+#include "core/shade_kernel.h"
+#include "core/terminal_writer.h"
+#include "core/vec3.h"
+#include "core/vulkan_renderer.h"
+
+#include "harness.h"
+
+namespace {
+
+template <typename T>
+void BenchRotate(bench::Suite& suite, const char* name) {
+  suite.Run(name, [](int64_t iterations) {
+    core::Vec3T<T> point{0.3, -0.2, 0.7};
+    const core::Vec3T<T> axis = core::Vec3T<T>{0.1, 0.2, 0.5}.Normalized();
+    const core::Vec3T<T> center{0.5, 0.5, 0.5};
+    for (int64_t i = 0; i < iterations; ++i) {
+      point = core::Rotate(point, axis, (T)0.01, center);
+      bench::KeepAlive(point);
+    }
+  });
+}
+
+template <typename T>
+void BenchQuatMul(bench::Suite& suite, const char* name) {
+  suite.Run(name, [](int64_t iterations) {
+    core::QuatT<T> q = core::QuatT<T>::FromAxisAndAngle({0, 0, 1}, 0.1);
+    const core::QuatT<T> step =
+        core::QuatT<T>::FromAxisAndAngle(core::Vec3T<T>{1, 1, 0}.Normalized(),
+                                         0.01);
+    for (int64_t i = 0; i < iterations; ++i) {
+      q = q * step;
+      bench::KeepAlive(q);
+    }
+  });
+}
+
+void BenchObjects(bench::Suite& suite) {
+  for (const int precision : {50, 100, 200}) {
+    suite.Run("donut/precision=" + std::to_string(precision),
+              [precision](int64_t iterations) {
+                for (int64_t i = 0; i < iterations; ++i) {
+                  Donutf donut(config::kDonutMajorR, config::kDonutMinorR,
+                               precision);
+                  bench::KeepAlive(donut.Points().Size());
+                }
+              });
+  }
+  for (const int precision : {25, 50, 100}) {
+    suite.Run("cube/precision=" + std::to_string(precision),
+              [precision](int64_t iterations) {
+                for (int64_t i = 0; i < iterations; ++i) {
+                  Cubef cube(config::kCubeSideSize, precision);
+                  bench::KeepAlive(cube.Points().Size());
+                }
+              });
+  }
+}
+
+// one Start of a headless renderer is one whole clear, render, present frame
+void BenchRenderLoop(bench::Suite& suite) {
+  auto rend = Renderer::New({
+      .backend = core::kBackendHeadless,
+      .present_mode = core::kPresentInline,
+      .target_fps = 0,
+      .max_frames = 1,
+  });
+  if (!rend) {
+    std::cerr << core::ResultToString(rend.error()) << std::endl;
+    return;
+  }
+  std::unique_ptr<Renderer> renderer(*rend);
+
+  suite.Run("renderer/frame", [&](int64_t iterations) {
+    for (int64_t i = 0; i < iterations; ++i) {
+      renderer->Start();
+    }
+  });
+}
+
+// one iteration puts or clears every cell of a window sized frame, or clears
+// and resolves one with a donut sized middle of it put into
+void BenchPutClear(bench::Suite& suite) {
+  const std::pair<core::FramebufferMode, const char*> modes[] = {
+      {core::kFramebufferDepth, "depth"},
+      {core::kFramebufferPacked, "packed"},
+      {core::kFramebufferEpoch, "epoch"},
+  };
+  for (const auto& [mode, mode_name] : modes) {
+    auto rend = core::VulkanRenderer::New({
+        .width = config::kWindowWidth,
+        .height = config::kWindowHeight,
+        .backend = core::kBackendHeadless,
+        .framebuffer_mode = mode,
+    });
+    if (!rend) {
+      std::cerr << core::ResultToString(rend.error()) << std::endl;
+      return;
+    }
+    std::unique_ptr<core::VulkanRenderer> renderer(*rend);
+
+    suite.Run(std::string("vulkan_renderer/put/") + mode_name,
+              [&](int64_t iterations) {
+                for (int64_t i = 0; i < iterations; ++i) {
+                  for (int y = 0; y <= renderer->Bot(); ++y) {
+                    for (int x = 0; x <= renderer->Right(); ++x) {
+                      renderer->Put(x, y, '#');
+                    }
+                  }
+                }
+              });
+    suite.Run(std::string("vulkan_renderer/put_at/") + mode_name,
+              [&](int64_t iterations) {
+                const int size = renderer->GetWidth() * renderer->GetHeight();
+                for (int64_t i = 0; i < iterations; ++i) {
+                  for (int cell = 0; cell < size; ++cell) {
+                    renderer->PutAt(cell, (cell * 7 + i) % 13 * 0.1, '#');
+                  }
+                }
+              });
+    suite.Run(std::string("vulkan_renderer/clear/") + mode_name,
+              [&](int64_t iterations) {
+                for (int64_t i = 0; i < iterations; ++i) {
+                  renderer->Clear();
+                }
+              });
+    suite.Run(std::string("vulkan_renderer/clear_resolve/") + mode_name,
+              [&](int64_t iterations) {
+                const int width = renderer->GetWidth();
+                const int height = renderer->GetHeight();
+                for (int64_t i = 0; i < iterations; ++i) {
+                  renderer->Clear();
+                  for (int y = height / 4; y < height * 3 / 4; ++y) {
+                    renderer->PutRun(y * width + width / 4, width / 2, 0.5,
+                                     '#');
+                  }
+                  bench::KeepAlive(renderer->ResolveChars().data());
+                }
+              });
+  }
+}
+
+// two consecutive donut frames as the renderer would draw them
+std::vector<core::Framebuffer> MakeDonutFrames() {
+  const Donutf donut(config::kDonutMajorR, config::kDonutMinorR,
+                     config::kDonutPrecision);
+  core::ParallelRasterizer rasterizer(1);
+  std::vector<core::Framebuffer> frames(2);
+
+  for (int i = 0; i < 2; ++i) {
+    const core::Rotation rotation(core::Vec3{0.1, 0.2, 0.5}, 1.0 + i * 0.1);
+    frames[i].Resize(config::kWindowWidth, config::kWindowHeight);
+    rasterizer.Rasterize(
+        donut.Points(),
+        {
+            .matrix = rotation.Matrix(),
+            .offset = rotation.Offset() + core::Vec3{0.5, 0.5, 0.5},
+            .aspect_ratio =
+                config::kWindowWidth / (double)config::kWindowHeight,
+            .light = config::kLightPoint,
+            .light_level_count = config::kLightLevelCount,
+            .width = config::kWindowWidth,
+            .height = config::kWindowHeight,
+            .lighting = config::kLightingMode,
+            .cull_back_faces = config::kCullBackFaces,
+        },
+        config::kLightLevles, frames[i]);
+  }
+  return frames;
+}
+
+// what DrawBuffer does with a frame, written to /dev/null
+void BenchPresent(bench::Suite& suite) {
+  const int fd = open("/dev/null", O_WRONLY);
+  if (fd < 0) {
+    std::cerr << "Could not open /dev/null" << std::endl;
+    return;
+  }
+  const std::vector<core::Framebuffer> frames = MakeDonutFrames();
+  core::Presenter presenter(config::kWindowWidth, config::kWindowHeight);
+  core::TerminalWriter writer(fd);
+
+  suite.Run("present/diff/dev_null", [&](int64_t iterations) {
+    for (int64_t i = 0; i < iterations; ++i) {
+      writer.Write(presenter.Present(frames[i % 2].Chars()));
+    }
+  });
+  suite.Run("present/full/dev_null", [&](int64_t iterations) {
+    for (int64_t i = 0; i < iterations; ++i) {
+      presenter.Invalidate();
+      writer.Write(presenter.Present(frames[i % 2].Chars()));
+    }
+  });
+  close(fd);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  bench::SuiteConfig config;
+  if (!bench::Suite::ParseArgs(argc, argv, config)) {
+    std::cerr << "usage: " << argv[0]
+              << " [--warmup=N] [--repetitions=N] [--min-time-ms=N]"
+                 " [--filter=SUBSTRING] [--format=table|json|csv]"
+              << std::endl;
+    return 1;
+  }
+  bench::Suite suite(config);
+
+  BenchRotate<float>(suite, "rotate/float");
+  BenchRotate<double>(suite, "rotate/double");
+  BenchQuatMul<float>(suite, "quat_mul/float");
+  BenchQuatMul<double>(suite, "quat_mul/double");
+  BenchObjects(suite);
+  BenchRenderLoop(suite);
+  BenchPutClear(suite);
+  BenchPresent(suite);
+
+  suite.Print(std::cout);
+}
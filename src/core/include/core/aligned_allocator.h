@@ -0,0 +1,54 @@
+#ifndef DONUTCPP_CORE_ALIGNED_ALLOCATOR_H_
+#define DONUTCPP_CORE_ALIGNED_ALLOCATOR_H_
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace core {
+
+/**
+ * Standard allocator that aligns every allocation to `Alignment` bytes,
+ * used for arrays that are processed with SIMD instructions. Memory comes
+ * from a std::pmr::memory_resource, the default one unless given.
+ */
+template <typename T, std::size_t Alignment>
+class AlignedAllocator {
+  static_assert(Alignment >= alignof(T));
+  static_assert((Alignment & (Alignment - 1)) == 0);
+
+ public:
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() = default;
+  AlignedAllocator(std::pmr::memory_resource* resource)
+      : resource_(resource) {}
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment>& other)
+      : resource_(other.Resource()) {}
+
+  inline T* allocate(std::size_t count) {
+    return static_cast<T*>(resource_->allocate(count * sizeof(T), Alignment));
+  }
+  inline void deallocate(T* ptr, std::size_t count) {
+    resource_->deallocate(ptr, count * sizeof(T), Alignment);
+  }
+
+  inline std::pmr::memory_resource* Resource() const { return resource_; }
+
+  template <typename U>
+  inline bool operator==(const AlignedAllocator<U, Alignment>& other) const {
+    return resource_->is_equal(*other.Resource());
+  }
+
+ private:
+  std::pmr::memory_resource* resource_ = std::pmr::get_default_resource();
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_ALIGNED_ALLOCATOR_H_
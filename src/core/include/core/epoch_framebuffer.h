@@ -0,0 +1,121 @@
+#ifndef DONUTCPP_CORE_EPOCH_FRAMEBUFFER_H_
+#define DONUTCPP_CORE_EPOCH_FRAMEBUFFER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace core {
+
+/**
+ * Framebuffer whose cells carry the frame (epoch) they were written in.
+ * A cell with a stale epoch reads as empty, ' ' with depth 0.0, so Clear only
+ * bumps the epoch and only cells that are put into get written. Each row
+ * keeps the span of columns put into this frame, so ResolveChars only
+ * visits those and last frame's.
+ * Depth testing matches Framebuffer::PutAt.
+ */
+class EpochFramebuffer {
+ public:
+  EpochFramebuffer() = default;
+  EpochFramebuffer(int width, int height);
+
+  void Resize(int width, int height);
+  // O(1) except once every 2^32 frames when every stamp is reset
+  void Clear();
+
+  inline int GetWidth() const { return width_; }
+  inline int GetHeight() const { return height_; }
+  inline int Size() const { return width_ * height_; }
+  inline uint32_t Epoch() const { return epoch_; }
+
+  // puts a char `sym` at buffer index `index`, doesn't check bounds
+  inline void Put(int index, char sym) {
+    Cell& cell = cells_[index];
+    if (cell.epoch != epoch_) {
+      Touch(index);
+      cell = Cell{.depth = 0.0, .epoch = epoch_, .sym = sym};
+    } else {
+      cell.sym = sym;
+    }
+  }
+  /**
+   * puts a char `sym` at buffer index `index` if `depth` is closer than what
+   * is already there, doesn't check bounds. Concurrent calls have to be on
+   * different rows
+   */
+  inline void PutAt(int index, double depth, char sym) {
+    Cell& cell = cells_[index];
+    const bool stale = cell.epoch != epoch_;
+    const double current = stale ? 0.0 : cell.depth;
+    if (current < depth) {
+      if (stale) {
+        Touch(index);
+      }
+      cell = Cell{.depth = depth, .epoch = epoch_, .sym = sym};
+    }
+  }
+
+  inline char CharAt(int index) const {
+    const Cell& cell = cells_[index];
+    return cell.epoch == epoch_ ? cell.sym : ' ';
+  }
+  inline double DepthAt(int index) const {
+    const Cell& cell = cells_[index];
+    return cell.epoch == epoch_ ? cell.depth : 0.0;
+  }
+
+  /**
+   * writes chars of the current frame to `target` of the same size. Only
+   * the spans put into this frame and the last resolved one are written, so
+   * `target` has to be what the last call wrote to, or blank after Resize
+   */
+  void ResolveChars(std::span<char> target);
+
+ private:
+  // depth, stamp and char share a cache line so a depth test is one load
+  struct Cell {
+    double depth;
+    uint32_t epoch;
+    char sym;
+  };
+  // columns [begin, end) of a row, empty when `epoch` is stale
+  struct Span {
+    uint32_t epoch;
+    int begin;
+    int end;
+  };
+
+  // begins past its end so min/max with it keep the other span
+  inline Span EmptySpan() const {
+    return Span{.epoch = 0, .begin = width_, .end = 0};
+  }
+
+  // widens the span of the row of `index`, once per cell and frame
+  inline void Touch(int index) {
+    const int y = index / width_;
+    const int x = index - y * width_;
+    Span& row = rows_[y];
+    if (row.epoch != epoch_) {
+      row = Span{.epoch = epoch_, .begin = x, .end = x + 1};
+    } else {
+      row.begin = std::min(row.begin, x);
+      row.end = std::max(row.end, x + 1);
+    }
+  }
+
+  int width_ = 0;
+  int height_ = 0;
+  // starts at 1 so zeroed cells are stale
+  uint32_t epoch_ = 1;
+  std::vector<Cell> cells_;
+  // spans put into this frame
+  std::vector<Span> rows_;
+  // spans the last ResolveChars wrote chars to
+  std::vector<Span> resolved_;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_EPOCH_FRAMEBUFFER_H_
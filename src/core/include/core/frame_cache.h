@@ -0,0 +1,97 @@
+#ifndef DONUTCPP_CORE_FRAME_CACHE_H_
+#define DONUTCPP_CORE_FRAME_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace core {
+
+struct FrameCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+  int64_t evictions = 0;
+  // encoded frames plus bookkeeping, never above the budget
+  std::size_t bytes = 0;
+  int64_t entries = 0;
+};
+
+/**
+ * Finished frames of chars stored under a caller-chosen key, run-length
+ * encoded, within a memory budget. The least recently used frames are
+ * evicted first.
+ * A run is stored as its char followed by its length as a LEB128 varint, so
+ * the mostly blank frames of an ASCII animation take a few KB each.
+ */
+class FrameCache {
+ public:
+  // counted per entry on top of its encoded frame
+  static constexpr std::size_t kEntryOverhead = 64;
+
+  explicit FrameCache(std::size_t budget_bytes = 0);
+
+  // drops every frame that doesn't fit in the new budget
+  void SetBudget(std::size_t budget_bytes);
+  void Clear();
+
+  // stores `frame` under `key`, replacing what was there; frames bigger
+  // than the budget are not stored
+  void Insert(uint64_t key, std::span<const char> frame);
+
+  /**
+   * calls `visit(index, length, sym)` for every run of the frame under
+   * `key` in order, false on a miss
+   */
+  template <typename Visitor>
+  bool Visit(uint64_t key, Visitor&& visit) {
+    const std::vector<uint8_t>* runs = Find(key);
+    if (!runs) {
+      return false;
+    }
+
+    const uint8_t* in = runs->data();
+    const uint8_t* end = in + runs->size();
+    int index = 0;
+    while (in < end) {
+      const char sym = *in++;
+      int length = 0;
+      for (int shift = 0;; shift += 7) {
+        length |= (*in & 0x7f) << shift;
+        if (!(*in++ & 0x80)) {
+          break;
+        }
+      }
+      visit(index, length, sym);
+      index += length;
+    }
+    return true;
+  }
+  // copies the frame under `key` into `out`, false on a miss
+  bool Lookup(uint64_t key, std::span<char> out);
+
+  inline const FrameCacheStats& Stats() const { return stats_; }
+
+ private:
+  struct Entry {
+    uint64_t key;
+    std::vector<uint8_t> runs;
+  };
+
+  // the runs of `key`, marked as most recently used, nullptr on a miss
+  const std::vector<uint8_t>* Find(uint64_t key);
+  void Erase(std::list<Entry>::iterator entry);
+  void EvictToBudget();
+
+  std::size_t budget_;
+  // most recently used first
+  std::list<Entry> lru_;
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> entries_;
+  FrameCacheStats stats_;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_FRAME_CACHE_H_
@@ -0,0 +1,76 @@
+#ifndef DONUTCPP_CORE_FRAME_PACER_H_
+#define DONUTCPP_CORE_FRAME_PACER_H_
+
+#include <chrono>
+#include <cstdint>
+
+#include "core/latency_histogram.h"
+
+namespace core {
+
+// what FramePacer does when a frame takes longer than its period
+enum OverrunPolicy {
+  // later frames start right away until the schedule is met again, the
+  // frame count over time stays the same
+  kOverrunCatchUp = 0,
+  // the missed frame slots are dropped, the next frame waits for the next
+  // slot of the schedule
+  kOverrunSkip,
+};
+
+struct PacerStats {
+  // how late Wait returned after the deadline it slept for
+  LatencyHistogram wake_error;
+  // time between the starts of consecutive frames
+  LatencyHistogram intervals;
+  int64_t overruns = 0;
+  // frame slots dropped by kOverrunSkip or by giving up catching up
+  int64_t skipped = 0;
+};
+
+/**
+ * Paces frames to absolute steady_clock deadlines one period apart, so an
+ * oversleep is made up for by the next frame instead of adding up.
+ * Sleeps until `spin` before the deadline and busy-waits the rest, which
+ * trades a bit of CPU for sub-millisecond accuracy.
+ */
+class FramePacer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // kOverrunCatchUp gives up and starts over when it is this many frames late
+  static constexpr int64_t kMaxCatchUpFrames = 4;
+
+  FramePacer() = default;
+  // a zero `period` never waits, it only measures the frames
+  FramePacer(std::chrono::nanoseconds period,
+             std::chrono::nanoseconds spin,
+             OverrunPolicy policy);
+
+  // the first frame begins at `now`
+  void Start(Clock::time_point now = Clock::now());
+  /**
+   * waits until the next frame is due and returns the seconds between the
+   * beginning of the previous frame and the next one
+   */
+  double Wait();
+
+  inline Clock::time_point Deadline() const { return deadline_; }
+  inline const PacerStats& Stats() const { return stats_; }
+
+ private:
+  // returns when it woke up
+  Clock::time_point SleepUntil(Clock::time_point deadline) const;
+
+  std::chrono::nanoseconds period_{0};
+  std::chrono::nanoseconds spin_{0};
+  OverrunPolicy policy_ = kOverrunCatchUp;
+
+  Clock::time_point frame_begin_;
+  Clock::time_point deadline_;
+  PacerStats stats_;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_FRAME_PACER_H_
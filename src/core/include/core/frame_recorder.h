@@ -0,0 +1,162 @@
+#ifndef DONUTCPP_CORE_FRAME_RECORDER_H_
+#define DONUTCPP_CORE_FRAME_RECORDER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/frame_sink.h"
+#include "core/presenter.h"
+#include "core/result.h"
+
+namespace core {
+
+enum RecordFormat {
+  // every frame stored whole
+  kRecordRaw = 0,
+  // frames stored as the spans that changed since the previous one, with a
+  // whole frame every keyframe_interval frames
+  kRecordRawDelta,
+  // asciicast v2, frames are the terminal output of Presenter
+  kRecordAsciicast,
+};
+
+struct RecorderConfig {
+  int width = 0;
+  int height = 0;
+  RecordFormat format = kRecordRaw;
+  // playback seeks at most this many frames back to a whole frame
+  int keyframe_interval = 60;
+  // seconds between recorded frames, 0 stamps them with the wall clock
+  double frame_interval = 0.0;
+  // the file is grown and remapped this many bytes at a time
+  std::size_t chunk_size = std::size_t{64} << 20;
+};
+
+/**
+ * Raw recording layout, all integers little-endian (native):
+ * RecordingHeader, then per frame a RecordHeader and its payload, then the
+ * index: a uint64 frame count and a uint64 file offset per frame record.
+ * Records and the index start at multiples of 8.
+ * A key payload is width * height chars, a delta payload is runs of a
+ * uint32 offset, a uint32 length and that many chars.
+ */
+struct RecordingHeader {
+  char magic[8];
+  uint32_t width;
+  uint32_t height;
+  uint32_t format;
+  uint32_t keyframe_interval;
+  // 0 until the recording is finished
+  uint64_t index_offset;
+};
+
+struct RecordHeader {
+  uint64_t time_ns;
+  uint32_t payload_size;
+  // kRecordKey or kRecordDelta
+  uint32_t kind;
+};
+
+inline constexpr char kRecordingMagic[8] = {'D', 'V', 'R', 'E',
+                                            'C', 'v', '1', '\0'};
+inline constexpr uint32_t kRecordKey = 0;
+inline constexpr uint32_t kRecordDelta = 1;
+
+/**
+ * FrameSink that streams frames into a memory-mapped file, grown by
+ * chunk_size at a time, so a frame costs a copy (or a diff) into the page
+ * cache and no write syscall.
+ * Asciicast recordings can't hold the index, it is written next to them as
+ * `<path>.idx` in the same layout.
+ */
+class FrameRecorder : public FrameSink {
+ public:
+  // creates or truncates the file at `path`
+  static std::expected<FrameRecorder*, Result> New(
+      const char* path,
+      const RecorderConfig& config);
+
+  FrameRecorder(const FrameRecorder&) = delete;
+  FrameRecorder& operator=(const FrameRecorder&) = delete;
+  // finishes the recording if Finish wasn't called
+  ~FrameRecorder() override;
+
+  // kRecordingFailed if `frame` isn't width * height chars
+  Result Consume(std::span<const char> frame) override;
+  // writes the index, trims the file to its size and unmaps it
+  Result Finish();
+
+  inline int64_t FrameCount() const { return offsets_.size(); }
+  // file offset of every frame record, or event line for asciicast
+  inline const std::vector<uint64_t>& Offsets() const { return offsets_; }
+  inline std::size_t Size() const { return size_; }
+
+ private:
+  FrameRecorder(int fd, const char* path, const RecorderConfig& config);
+
+  // makes room for `bytes` more bytes past Size
+  Result Reserve(std::size_t bytes);
+  void Append(const void* bytes, std::size_t count);
+  uint64_t FrameTimeNs();
+
+  void AppendKey(std::span<const char> frame, uint64_t time_ns);
+  // false if the diff isn't smaller than a key frame
+  bool AppendDelta(std::span<const char> frame, uint64_t time_ns);
+  void AppendAsciicastEvent(std::string_view output, uint64_t time_ns);
+  Result WriteIndex(int fd, uint64_t offset);
+
+  int fd_;
+  std::string path_;
+  RecorderConfig cfg_;
+  char* data_ = nullptr;
+  std::size_t size_ = 0;
+  std::size_t capacity_ = 0;
+  bool finished_ = false;
+
+  std::vector<uint64_t> offsets_;
+  std::vector<char> previous_;
+  Presenter presenter_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// random access to the frames of a raw recording
+class RecordingReader {
+ public:
+  static std::expected<RecordingReader*, Result> New(const char* path);
+
+  RecordingReader(const RecordingReader&) = delete;
+  RecordingReader& operator=(const RecordingReader&) = delete;
+  ~RecordingReader();
+
+  inline int GetWidth() const { return header_.width; }
+  inline int GetHeight() const { return header_.height; }
+  inline int64_t FrameCount() const { return frame_count_; }
+
+  /**
+   * writes frame `index` (width * height chars) to `out`, delta frames are
+   * replayed from the closest key frame before it
+   */
+  Result ReadFrame(int64_t index, std::span<char> out) const;
+  uint64_t FrameTimeNs(int64_t index) const;
+
+ private:
+  RecordingReader() = default;
+
+  const RecordHeader& RecordAt(int64_t index) const;
+
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+  RecordingHeader header_ = {};
+  int64_t frame_count_ = 0;
+  const uint64_t* offsets_ = nullptr;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_FRAME_RECORDER_H_
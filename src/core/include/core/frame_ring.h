@@ -0,0 +1,75 @@
+#ifndef DONUTCPP_CORE_FRAME_RING_H_
+#define DONUTCPP_CORE_FRAME_RING_H_
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace core {
+
+/**
+ * Lock-free single-producer single-consumer exchange of char frames through
+ * three preallocated slots: one the producer fills, one the consumer reads
+ * and one holding the latest published frame.
+ * Publishing over a frame the consumer hasn't taken yet drops it, so a slow
+ * consumer always gets the newest frame and the producer never waits.
+ */
+class FrameRing {
+ public:
+  static constexpr int kSlotCount = 3;
+
+  FrameRing() = default;
+  explicit FrameRing(int frame_size);
+
+  FrameRing(const FrameRing&) = delete;
+  FrameRing& operator=(const FrameRing&) = delete;
+
+  // not thread-safe, drops every frame
+  void Resize(int frame_size);
+
+  // producer: the frame to fill before Publish
+  inline std::span<char> Back() { return slots_[back_]; }
+  // producer: hands the back frame to the consumer
+  void Publish();
+
+  // consumer: takes the latest published frame into Front, false if there is
+  // no new one
+  bool TryAcquire();
+  /**
+   * consumer: waits for a new frame and takes it into Front, false once
+   * Close was called and every published frame was taken
+   */
+  bool WaitAcquire();
+  // consumer: the frame taken last
+  inline std::span<const char> Front() const { return slots_[front_]; }
+
+  // wakes up the consumer for good, called by the producer
+  void Close();
+
+  inline int64_t Published() const {
+    return published_.load(std::memory_order_relaxed);
+  }
+  // frames that were replaced before the consumer took them
+  inline int64_t Dropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // set in `latest_` when the slot holds a frame the consumer hasn't taken
+  static constexpr uint32_t kFresh = 1u << 31;
+
+  std::vector<char> slots_[kSlotCount];
+  // slot indices owned by the producer and the consumer
+  int back_ = 0;
+  int front_ = 2;
+  alignas(64) std::atomic<uint32_t> latest_ = 1;
+  // bumped on every publish and on close, waited on by the consumer
+  alignas(64) std::atomic<int64_t> published_ = 0;
+  std::atomic<int64_t> dropped_ = 0;
+  std::atomic<bool> closed_ = false;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_FRAME_RING_H_
@@ -0,0 +1,66 @@
+#ifndef DONUTCPP_CORE_FRAME_SINK_H_
+#define DONUTCPP_CORE_FRAME_SINK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <vector>
+
+#include "core/result.h"
+#include "core/terminal_writer.h"
+
+namespace core {
+
+// receives the frames of VulkanRenderer::RenderBatch
+class FrameSink {
+ public:
+  virtual ~FrameSink() = default;
+  // `frame` is width * height chars, valid only during the call
+  virtual Result Consume(std::span<const char> frame) = 0;
+};
+
+// drops every frame, measures rendering alone
+class NullSink : public FrameSink {
+ public:
+  Result Consume(std::span<const char> frame) override;
+};
+
+// keeps every frame back to back
+class MemorySink : public FrameSink {
+ public:
+  // preallocates `capacity` bytes, e.g. frames * width * height
+  explicit MemorySink(std::size_t capacity = 0);
+
+  Result Consume(std::span<const char> frame) override;
+
+  inline const std::vector<char>& Frames() const { return frames_; }
+  inline int64_t FrameCount() const { return frame_count_; }
+
+ private:
+  std::vector<char> frames_;
+  int64_t frame_count_ = 0;
+};
+
+// writes raw frames back to back to a file
+class FileSink : public FrameSink {
+ public:
+  // creates or truncates the file at `path`
+  static std::expected<FileSink*, Result> New(const char* path);
+
+  FileSink(const FileSink&) = delete;
+  FileSink& operator=(const FileSink&) = delete;
+  ~FileSink() override;
+
+  Result Consume(std::span<const char> frame) override;
+
+ private:
+  explicit FileSink(int fd);
+
+  int fd_;
+  TerminalWriter writer_;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_FRAME_SINK_H_
@@ -0,0 +1,46 @@
+#ifndef DONUTCPP_CORE_FRAME_STATS_H_
+#define DONUTCPP_CORE_FRAME_STATS_H_
+
+#include <ostream>
+
+#include "core/latency_histogram.h"
+#include "core/result.h"
+
+namespace core {
+
+// parts of a VulkanRenderer frame, in the order they run
+enum FrameStage {
+  kStageClear = 0,
+  // the render handler up to the point it marks kStageRaster
+  kStageSimulate,
+  kStageRaster,
+  // handing the frame to the backend, only the hand-off in kPresentThread
+  kStagePresent,
+  // sleeping until the next frame is due
+  kStageIdle,
+  kFrameStageCount,
+};
+
+const char* FrameStageName(FrameStage stage);
+
+enum StatsFormat {
+  kStatsJson = 0,
+  kStatsCsv,
+};
+
+// durations of every frame and every stage of it
+struct FrameStats {
+  LatencyHistogram stages[kFrameStageCount];
+  // whole frames, the sum of their stages
+  LatencyHistogram frames;
+
+  void Reset();
+  // count, min, mean, p50, p95, p99, p99.9 and max of each histogram
+  void Write(std::ostream& out, StatsFormat format) const;
+  // replaces the file at `path`
+  Result WriteFile(const char* path, StatsFormat format) const;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_FRAME_STATS_H_
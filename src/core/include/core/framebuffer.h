@@ -0,0 +1,58 @@
+#ifndef DONUTCPP_CORE_FRAMEBUFFER_H_
+#define DONUTCPP_CORE_FRAMEBUFFER_H_
+
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace core {
+
+/**
+ * Screen of chars with a depth buffer. A cleared cell holds ' ' with depth
+ * 0.0, a char is written only when its depth is greater than the cell's.
+ */
+class Framebuffer {
+ public:
+  Framebuffer() = default;
+  // both buffers are allocated from `resource`
+  explicit Framebuffer(std::pmr::memory_resource* resource);
+  Framebuffer(
+      int width,
+      int height,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  void Resize(int width, int height);
+  void Clear();
+
+  inline int GetWidth() const { return width_; }
+  inline int GetHeight() const { return height_; }
+  inline int Size() const { return width_ * height_; }
+
+  // puts a char `sym` at buffer index `index`, doesn't check bounds
+  inline void Put(int index, char sym) { chars_[index] = sym; }
+  /**
+   * puts a char `sym` at buffer index `index` if `depth` is closer than what
+   * is already there, doesn't check bounds
+   */
+  inline void PutAt(int index, double depth, char sym) {
+    if (depths_[index] < depth) {
+      depths_[index] = depth;
+      chars_[index] = sym;
+    }
+  }
+
+  inline std::span<const char> Chars() const { return chars_; }
+  inline std::span<char> Chars() { return chars_; }
+  inline std::span<const double> Depths() const { return depths_; }
+  inline std::span<double> Depths() { return depths_; }
+
+ private:
+  int width_ = 0;
+  int height_ = 0;
+  std::pmr::vector<char> chars_;
+  std::pmr::vector<double> depths_;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_FRAMEBUFFER_H_
@@ -0,0 +1,71 @@
+#ifndef DONUTCPP_CORE_LATENCY_HISTOGRAM_H_
+#define DONUTCPP_CORE_LATENCY_HISTOGRAM_H_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+namespace core {
+
+/**
+ * Fixed-bucket histogram of durations in nanoseconds, HDR style: values below
+ * 64 get a bucket each, every power of two above that is split into 32
+ * linear buckets, so a percentile is off by at most 1/32 of the value.
+ * Record is O(1) and never allocates. Values from 2^40 ns (~18 minutes) up
+ * are counted in the last bucket.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 5;
+  static constexpr int kSubBucketCount = 1 << kSubBucketBits;
+  static constexpr int kMaxValueBits = 40;
+  static constexpr int kBucketCount =
+      (kMaxValueBits - kSubBucketBits + 1) * kSubBucketCount;
+  static constexpr int64_t kMaxValue = (int64_t{1} << kMaxValueBits) - 1;
+
+  inline void Record(int64_t ns) {
+    const uint64_t value = ns < 0 ? 0 : ns > kMaxValue ? kMaxValue : ns;
+    ++buckets_[BucketOf(value)];
+    ++count_;
+    sum_ += value;
+    min_ = value < min_ ? value : min_;
+    max_ = value > max_ ? value : max_;
+  }
+
+  void Reset();
+  // adds the values recorded by `other`
+  void Merge(const LatencyHistogram& other);
+
+  inline int64_t Count() const { return count_; }
+  // 0 when nothing was recorded, as are Max, Mean and Percentile
+  inline int64_t Min() const { return count_ ? min_ : 0; }
+  inline int64_t Max() const { return max_; }
+  inline double Mean() const { return count_ ? sum_ / (double)count_ : 0.0; }
+  /**
+   * the highest value of the bucket holding the `percent`-th percentile
+   * (nearest rank), clamped to Max
+   */
+  int64_t Percentile(double percent) const;
+
+  static inline int BucketOf(uint64_t value) {
+    const int shift =
+        std::max(0, (int)std::bit_width(value) - kSubBucketBits - 1);
+    return shift * kSubBucketCount + (int)(value >> shift);
+  }
+  // the lowest value counted in `bucket`
+  static int64_t BucketBegin(int bucket);
+  // the highest value counted in `bucket`
+  static int64_t BucketEnd(int bucket);
+
+ private:
+  std::array<int64_t, kBucketCount> buckets_ = {};
+  int64_t count_ = 0;
+  uint64_t sum_ = 0;
+  uint64_t min_ = kMaxValue;
+  uint64_t max_ = 0;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_LATENCY_HISTOGRAM_H_
@@ -0,0 +1,67 @@
+#ifndef DONUTCPP_CORE_MAT3_H_
+#define DONUTCPP_CORE_MAT3_H_
+
+#include "vec3.h"
+
+namespace core {
+
+// row-major 3x3 matrix
+template <typename T>
+struct Mat3T {
+ public:
+  T m[3][3];
+
+  inline static Mat3T Identity() {
+    return Mat3T{{
+        {1, 0, 0},
+        {0, 1, 0},
+        {0, 0, 1},
+    }};
+  }
+
+  inline Mat3T Transposed() const {
+    return Mat3T{{
+        {m[0][0], m[1][0], m[2][0]},
+        {m[0][1], m[1][1], m[2][1]},
+        {m[0][2], m[1][2], m[2][2]},
+    }};
+  }
+
+  // converts to a matrix of another precision
+  template <typename U>
+  inline Mat3T<U> As() const {
+    Mat3T<U> result;
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 3; ++col) {
+        result.m[row][col] = (U)m[row][col];
+      }
+    }
+    return result;
+  }
+
+  inline Vec3T<T> operator*(const Vec3T<T>& v) const {
+    return Vec3T<T>{
+        .x = m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+        .y = m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+        .z = m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z,
+    };
+  }
+  inline Mat3T operator*(const Mat3T& other) const {
+    Mat3T result;
+    for (int row = 0; row < 3; ++row) {
+      for (int col = 0; col < 3; ++col) {
+        result.m[row][col] = m[row][0] * other.m[0][col] +
+                             m[row][1] * other.m[1][col] +
+                             m[row][2] * other.m[2][col];
+      }
+    }
+    return result;
+  }
+};
+
+using Mat3 = Mat3T<double>;
+using Mat3f = Mat3T<float>;
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_MAT3_H_
@@ -1,22 +1,29 @@
 #ifndef DONUTCPP_CORE_OBJECT_H_
 #define DONUTCPP_CORE_OBJECT_H_
 
-#include <vector>
+#include <memory_resource>
 
-#include "point_info.h"
+#include "point_cloud.h"
 
 namespace core {
 
-class Object {
+template <typename T>
+class ObjectT {
  public:
-  inline std::vector<PointInfo> const& Points() const { return points_; }
+  using Scalar = T;
+
+  inline PointCloudT<T> const& Points() const { return points_; }
 
  protected:
-  Object() {}
+  ObjectT() {}
+  explicit ObjectT(std::pmr::memory_resource* resource) : points_(resource) {}
 
-  std::vector<PointInfo> points_;
+  PointCloudT<T> points_;
 };
 
+using Object = ObjectT<double>;
+using Objectf = ObjectT<float>;
+
 }  // namespace core
 
 #endif  // DONUTCPP_CORE_OBJECT_H_
@@ -0,0 +1,95 @@
+#ifndef DONUTCPP_CORE_PACKED_FRAMEBUFFER_H_
+#define DONUTCPP_CORE_PACKED_FRAMEBUFFER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "framebuffer.h"
+
+namespace core {
+
+/**
+ * Framebuffer that packs depth and char of a cell into one 32-bit word:
+ * depth in [0, 1) quantized to the upper 24 bits, char in the lower 8 bits.
+ * Comparing words compares depths first, so a depth tested put is a single
+ * atomic max and any number of threads may put into the same buffer without
+ * locks or a merge step. An empty cell is 0, same as depth 0.0 in
+ * Framebuffer, so only depths above 0 are put.
+ * Points with equal quantized depth keep the bigger char, which makes the
+ * result independent of put order.
+ */
+class PackedFramebuffer {
+ public:
+  static constexpr int kDepthBits = 24;
+  static constexpr uint32_t kMaxDepth = (1u << kDepthBits) - 1;
+
+  PackedFramebuffer() = default;
+  PackedFramebuffer(int width, int height);
+
+  void Resize(int width, int height);
+  // not thread-safe
+  void Clear();
+
+  inline int GetWidth() const { return width_; }
+  inline int GetHeight() const { return height_; }
+  inline int Size() const { return width_ * height_; }
+
+  // puts a char `sym` at buffer index `index` keeping its depth, thread-safe
+  inline void Put(int index, char sym) {
+    std::atomic<uint32_t>& cell = cells_[index];
+    uint32_t current = cell.load(std::memory_order_relaxed);
+    while (!cell.compare_exchange_weak(current,
+                                       (current & ~0xffu) | (uint8_t)sym,
+                                       std::memory_order_relaxed)) {
+    }
+  }
+  /**
+   * puts a char `sym` at buffer index `index` if `depth` is closer than what
+   * is already there, doesn't check bounds, thread-safe
+   */
+  inline void PutAt(int index, double depth, char sym) {
+    const uint32_t word = Pack(depth, sym);
+    if (word == 0) {
+      return;
+    }
+
+    std::atomic<uint32_t>& cell = cells_[index];
+    uint32_t current = cell.load(std::memory_order_relaxed);
+    while (current < word &&
+           !cell.compare_exchange_weak(current, word,
+                                       std::memory_order_relaxed)) {
+    }
+  }
+
+  inline uint32_t At(int index) const {
+    return cells_[index].load(std::memory_order_relaxed);
+  }
+
+  // writes chars and (quantized) depths to `target` of the same size
+  void Resolve(Framebuffer& target) const;
+
+  // 0 (nothing to put) when depth is not above 0
+  inline static uint32_t Pack(double depth, char sym) {
+    if (!(depth > 0.0)) {
+      return 0;
+    }
+    const double scaled = depth * (1u << kDepthBits);
+    const uint32_t quantized =
+        scaled < kMaxDepth ? (uint32_t)scaled + 1 : kMaxDepth;
+    return (quantized << 8) | (uint8_t)sym;
+  }
+  inline static double UnpackDepth(uint32_t word) {
+    return (word >> 8) / (double)(1u << kDepthBits);
+  }
+  inline static char UnpackChar(uint32_t word) { return (char)(word & 0xff); }
+
+ private:
+  int width_ = 0;
+  int height_ = 0;
+  std::unique_ptr<std::atomic<uint32_t>[]> cells_;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_PACKED_FRAMEBUFFER_H_
@@ -0,0 +1,144 @@
+#ifndef DONUTCPP_CORE_PARALLEL_RASTER_H_
+#define DONUTCPP_CORE_PARALLEL_RASTER_H_
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "epoch_framebuffer.h"
+#include "framebuffer.h"
+#include "packed_framebuffer.h"
+#include "point_cloud.h"
+#include "shade_kernel.h"
+#include "thread_pool.h"
+
+namespace core {
+
+// per-frame point statistics of ParallelRasterizer::Rasterize
+struct RasterCounters {
+  int64_t points = 0;
+  int64_t off_screen = 0;
+  // back-facing points dropped before the depth test
+  int64_t culled = 0;
+  // points that went through the depth test
+  int64_t drawn = 0;
+
+  RasterCounters& operator+=(const RasterCounters& other);
+};
+
+/**
+ * Rasterizes a point cloud on several threads.
+ * Points are split into one contiguous chunk per thread, every thread
+ * transforms, shades and depth tests its chunk into its own framebuffer, then
+ * the framebuffers are merged into the target in parallel row bands.
+ * Merging goes in chunk order with the same strict depth test as
+ * Framebuffer::PutAt, so the result is identical to putting every point one
+ * by one.
+ */
+class ParallelRasterizer {
+ public:
+  /**
+   * @param thread_count amount of threads including the calling one,
+   * 0 means one per hardware thread
+   */
+  explicit ParallelRasterizer(int thread_count = 0);
+
+  int ThreadCount() const;
+  // counters of the last Rasterize call
+  const RasterCounters& LastCounters() const;
+
+  /**
+   * Puts `points` transformed with `params` into `target`.
+   * `glyphs` maps light levels of the shade kernel to chars.
+   * `params` width and height must match `target`.
+   */
+  template <typename T>
+  void Rasterize(const PointCloudT<T>& points,
+                 const ShadeParams& params,
+                 std::string_view glyphs,
+                 Framebuffer& target);
+  template <typename T>
+  void Rasterize(const PointCloudT<T>& points,
+                 const ShadeParams& params,
+                 std::string_view glyphs,
+                 EpochFramebuffer& target);
+  /**
+   * Same as above, but every thread puts its chunk straight into `target`,
+   * there are no per-thread framebuffers and no merge pass.
+   */
+  template <typename T>
+  void Rasterize(const PointCloudT<T>& points,
+                 const ShadeParams& params,
+                 std::string_view glyphs,
+                 PackedFramebuffer& target);
+
+ private:
+  // points are shaded in blocks of this size to keep the scratch in cache
+  static constexpr int kBlockSize = 4096;
+
+  struct Worker {
+    Framebuffer frame;
+    std::vector<int32_t> cells;
+    std::vector<double> depths;
+    std::vector<uint8_t> glyphs;
+    // touched range of `frame`, empty when min_cell > max_cell
+    int min_cell = 0;
+    int max_cell = -1;
+    RasterCounters counters;
+  };
+
+  // per-thread framebuffers merged into `target`
+  template <typename T, typename Target>
+  void RasterizeMerged(const PointCloudT<T>& points,
+                       const ShadeParams& params,
+                       std::string_view glyphs,
+                       Target& target);
+  // shades points [begin, end), puts them into `frame` and counts them
+  // into `worker.counters`
+  template <typename T, typename Frame>
+  void RasterizeRange(const PointCloudT<T>& points,
+                      std::size_t begin,
+                      std::size_t end,
+                      const ShadeParams& params,
+                      std::string_view glyphs,
+                      Worker& worker,
+                      Frame& frame);
+  // merges cells [begin, end) of every worker into `target` and clears them
+  template <typename Target>
+  void MergeRange(int begin, int end, Target& target);
+  // sums the counters of every worker into `counters_`
+  void CollectCounters();
+
+  ThreadPool pool_;
+  std::vector<Worker> workers_;
+  RasterCounters counters_;
+};
+
+extern template void ParallelRasterizer::Rasterize(const PointCloudT<float>&,
+                                                   const ShadeParams&,
+                                                   std::string_view,
+                                                   Framebuffer&);
+extern template void ParallelRasterizer::Rasterize(const PointCloudT<double>&,
+                                                   const ShadeParams&,
+                                                   std::string_view,
+                                                   Framebuffer&);
+extern template void ParallelRasterizer::Rasterize(const PointCloudT<float>&,
+                                                   const ShadeParams&,
+                                                   std::string_view,
+                                                   EpochFramebuffer&);
+extern template void ParallelRasterizer::Rasterize(const PointCloudT<double>&,
+                                                   const ShadeParams&,
+                                                   std::string_view,
+                                                   EpochFramebuffer&);
+extern template void ParallelRasterizer::Rasterize(const PointCloudT<float>&,
+                                                   const ShadeParams&,
+                                                   std::string_view,
+                                                   PackedFramebuffer&);
+extern template void ParallelRasterizer::Rasterize(const PointCloudT<double>&,
+                                                   const ShadeParams&,
+                                                   std::string_view,
+                                                   PackedFramebuffer&);
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_PARALLEL_RASTER_H_
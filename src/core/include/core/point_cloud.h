@@ -0,0 +1,119 @@
+#ifndef DONUTCPP_CORE_POINT_CLOUD_H_
+#define DONUTCPP_CORE_POINT_CLOUD_H_
+
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "aligned_allocator.h"
+#include "point_info.h"
+#include "vec3.h"
+
+namespace core {
+
+/**
+ * Structure-of-arrays storage for points and their normals.
+ * Every component lives in its own array aligned to kAlignment bytes, so
+ * passes that need only positions or only normals touch only those arrays
+ * and can be vectorized.
+ * Iterating over PointCloudT or indexing it gives an array-of-structs view
+ * (PointInfoT by value).
+ */
+template <typename T>
+class PointCloudT {
+ public:
+  static constexpr std::size_t kAlignment = 64;
+  using Scalar = T;
+  using Array = std::vector<T, AlignedAllocator<T, kAlignment>>;
+
+  class ConstIterator {
+   public:
+    using iterator_concept = std::forward_iterator_tag;
+    using value_type = PointInfoT<T>;
+    using difference_type = std::ptrdiff_t;
+
+    ConstIterator() = default;
+    ConstIterator(const PointCloudT* cloud, std::size_t index)
+        : cloud_(cloud), index_(index) {}
+
+    inline PointInfoT<T> operator*() const { return (*cloud_)[index_]; }
+    inline ConstIterator& operator++() {
+      ++index_;
+      return *this;
+    }
+    inline ConstIterator operator++(int) {
+      ConstIterator prev = *this;
+      ++index_;
+      return prev;
+    }
+    inline bool operator==(const ConstIterator& other) const {
+      return index_ == other.index_;
+    }
+
+   private:
+    const PointCloudT* cloud_ = nullptr;
+    std::size_t index_ = 0;
+  };
+
+  PointCloudT() = default;
+  // every array is allocated from `resource`
+  explicit PointCloudT(std::pmr::memory_resource* resource);
+  explicit PointCloudT(
+      std::size_t size,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  void Resize(std::size_t size);
+  inline std::size_t Size() const { return x_.size(); }
+  inline bool Empty() const { return x_.empty(); }
+
+  void Set(std::size_t index, const PointInfoT<T>& point_info);
+  inline Vec3T<T> Position(std::size_t index) const {
+    return Vec3T<T>{x_[index], y_[index], z_[index]};
+  }
+  inline Vec3T<T> Normal(std::size_t index) const {
+    return Vec3T<T>{nx_[index], ny_[index], nz_[index]};
+  }
+  inline PointInfoT<T> operator[](std::size_t index) const {
+    return PointInfoT<T>{.p = Position(index), .normal = Normal(index)};
+  }
+
+  inline ConstIterator begin() const { return ConstIterator(this, 0); }
+  inline ConstIterator end() const { return ConstIterator(this, Size()); }
+
+  // component arrays, each is Size() long and aligned to kAlignment
+  inline std::span<const T> X() const { return x_; }
+  inline std::span<const T> Y() const { return y_; }
+  inline std::span<const T> Z() const { return z_; }
+  inline std::span<const T> Nx() const { return nx_; }
+  inline std::span<const T> Ny() const { return ny_; }
+  inline std::span<const T> Nz() const { return nz_; }
+  inline std::span<T> X() { return x_; }
+  inline std::span<T> Y() { return y_; }
+  inline std::span<T> Z() { return z_; }
+  inline std::span<T> Nx() { return nx_; }
+  inline std::span<T> Ny() { return ny_; }
+  inline std::span<T> Nz() { return nz_; }
+
+ private:
+  Array x_;
+  Array y_;
+  Array z_;
+  Array nx_;
+  Array ny_;
+  Array nz_;
+};
+
+using PointCloud = PointCloudT<double>;
+using PointCloudf = PointCloudT<float>;
+
+static_assert(std::forward_iterator<PointCloud::ConstIterator>);
+
+// defined in point_cloud.cc
+extern template class PointCloudT<float>;
+extern template class PointCloudT<double>;
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_POINT_CLOUD_H_
@@ -5,11 +5,15 @@
 
 namespace core {
 
-struct PointInfo {
-  Vec3 p;
-  Vec3 normal;
+template <typename T>
+struct PointInfoT {
+  Vec3T<T> p;
+  Vec3T<T> normal;
 };
 
+using PointInfo = PointInfoT<double>;
+using PointInfof = PointInfoT<float>;
+
 }  // namespace core
 
 #endif  // DONUTCPP_CORE_POINT_INFO_H_
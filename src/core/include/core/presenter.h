@@ -0,0 +1,65 @@
+#ifndef DONUTCPP_CORE_PRESENTER_H_
+#define DONUTCPP_CORE_PRESENTER_H_
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace core {
+
+struct PresentStats {
+  int64_t frames = 0;
+  // frames that were drawn whole instead of as a diff
+  int64_t full_redraws = 0;
+  int64_t last_frame_bytes = 0;
+  int64_t total_bytes = 0;
+};
+
+/**
+ * Turns frames of chars into terminal output.
+ * Keeps the last presented frame and emits only the changed spans of every
+ * row, each after a cursor move. Short unchanged gaps inside a row are
+ * rewritten, longer ones are skipped with a cursor forward. When the diff
+ * would not be smaller than the whole frame, the whole frame is drawn.
+ */
+class Presenter {
+ public:
+  Presenter() = default;
+  Presenter(int width, int height);
+
+  // forgets the presented frame, the next one is drawn whole
+  void Resize(int width, int height);
+  // the next frame is drawn whole, e.g. after the terminal was cleared
+  void Invalidate();
+
+  /**
+   * Returns the bytes that turn the previously presented frame into `frame`
+   * of width * height chars, valid until the next call.
+   */
+  std::string_view Present(std::span<const char> frame);
+
+  // the last presented frame, blank before the first one
+  inline std::span<const char> Presented() const { return previous_; }
+  inline const PresentStats& Stats() const { return stats_; }
+
+ private:
+  // appends the changed spans, false if they grew bigger than a full redraw
+  bool AppendDiff(std::span<const char> frame);
+  void AppendFull(std::span<const char> frame);
+  void AppendMove(int row, int col);
+  void AppendForward(int count);
+  void AppendNumber(int number);
+
+  int width_ = 0;
+  int height_ = 0;
+  bool presented_ = false;
+  std::vector<char> previous_;
+  std::string out_;
+  PresentStats stats_;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_PRESENTER_H_
@@ -7,25 +7,26 @@
 
 namespace core {
 
-struct Quat {
+template <typename T>
+struct QuatT {
  public:
-  double s;
-  double x;
-  double y;
-  double z;
+  T s;
+  T x;
+  T y;
+  T z;
 
-  inline static Quat FromAxisAndAngle(const Vec3& axis, double theta) {
-    const double sin_t_half = sin(theta / 2.0);
-    return Quat{
-        .s = cos(theta / 2.0),
+  inline static QuatT FromAxisAndAngle(const Vec3T<T>& axis, T theta) {
+    const T sin_t_half = std::sin(theta / 2);
+    return QuatT{
+        .s = std::cos(theta / 2),
         .x = sin_t_half * axis.x,
         .y = sin_t_half * axis.y,
         .z = sin_t_half * axis.z,
     };
   }
-  inline static Quat Pure(const Vec3& vector_part) {
-    return Quat{
-        .s = 0.0,
+  inline static QuatT Pure(const Vec3T<T>& vector_part) {
+    return QuatT{
+        .s = 0,
         .x = vector_part.x,
         .y = vector_part.y,
         .z = vector_part.z,
@@ -33,46 +34,51 @@ struct Quat {
   }
 
   inline void ToConjugate() { *this = Conjugate(); }
-  inline Quat Conjugate() const {
-    return Quat{
+  inline QuatT Conjugate() const {
+    return QuatT{
         .s = s,
         .x = -x,
         .y = -y,
         .z = -z,
     };
   }
-  inline Vec3 ExtractVector() const { return Vec3{x, y, z}; }
+  inline Vec3T<T> ExtractVector() const { return Vec3T<T>{x, y, z}; }
 
-  inline Quat operator*(const Quat& other) const {
-    return Quat{
+  inline QuatT operator*(const QuatT& other) const {
+    return QuatT{
         .s = s * other.s - x * other.x - y * other.y - z * other.z,
         .x = s * other.x + x * other.s + y * other.z - z * other.y,
         .y = s * other.y - x * other.z + y * other.s + z * other.x,
         .z = s * other.z + x * other.y - y * other.x + z * other.s,
     };
   }
-  inline Quat& operator*=(const Quat& other) {
+  inline QuatT& operator*=(const QuatT& other) {
     *this = *this * other;
     return *this;
   }
-  inline Quat operator+(const Quat& other) const {
-    return Quat{
+  inline QuatT operator+(const QuatT& other) const {
+    return QuatT{
         .s = s + other.s,
         .x = x + other.x,
         .y = y + other.y,
         .z = z + other.z,
     };
   }
-  inline Quat& operator+=(const Quat& other) {
+  inline QuatT& operator+=(const QuatT& other) {
     *this = *this + other;
     return *this;
   }
-  inline bool operator==(const Quat& other) const {
+  inline bool operator==(const QuatT& other) const {
     return s == other.s && x == other.x && y == other.y && z == other.z;
   }
-  inline bool operator!=(const Quat& other) const { return !(*this == other); }
+  inline bool operator!=(const QuatT& other) const {
+    return !(*this == other);
+  }
 };
 
+using Quat = QuatT<double>;
+using Quatf = QuatT<float>;
+
 }  // namespace core
 
 #endif  // DONUTCPP_CORE_QUATERNION_H_
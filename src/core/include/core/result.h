@@ -25,6 +25,10 @@ enum CoreError {
   kNotAllRequiredQueueFamiliesArePresent,
   kNoAvailableSurfaceFormats,
   kNoAvailableSurfacePresentModes,
+  kTerminalWriteFailed,
+  kFrameSinkWriteFailed,
+  kRecordingFailed,
+  kInvalidRecording,
 };
 
 struct FileError {
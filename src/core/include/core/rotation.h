@@ -1,6 +1,10 @@
 #ifndef DONUTCPP_CORE_ROTATION_H_
 #define DONUTCPP_CORE_ROTATION_H_
 
+#include <span>
+#include <type_traits>
+
+#include "mat3.h"
 #include "vec3.h"
 
 namespace core {
@@ -9,12 +13,84 @@ namespace core {
  * Rotates point `point` along axis `axis` by an angle `angle` around point
  * `center`
  *
- * @return rotated point as Vec3
+ * @return rotated point as Vec3T
+ */
+template <typename T>
+Vec3T<T> Rotate(const Vec3T<T>& point,
+                const Vec3T<T>& axis,
+                std::type_identity_t<T> angle,
+                const Vec3T<T>& center = {0, 0, 0});
+
+/**
+ * Rotation along an axis by an angle around a center point, precomputed into
+ * a 3x3 matrix and an offset. Rotations are composed with `Then`, so a chain
+ * of rotations costs one matrix-vector multiply per point.
+ * Default constructed RotationT is the identity.
+ */
+template <typename T>
+class RotationT {
+ public:
+  RotationT() = default;
+  RotationT(const Vec3T<T>& axis, T angle, const Vec3T<T>& center = {0, 0, 0});
+
+  // returns rotation that applies `*this` first and `next` after it
+  RotationT Then(const RotationT& next) const;
+
+  Vec3T<T> Apply(const Vec3T<T>& point) const;
+  // rotates a direction (e.g. a normal), center is ignored
+  Vec3T<T> ApplyToDirection(const Vec3T<T>& direction) const;
+
+  // `out` must be at least as big as `in`, `in` and `out` may be the same
+  void Apply(std::span<const Vec3T<T>> in, std::span<Vec3T<T>> out) const;
+  void ApplyToDirection(std::span<const Vec3T<T>> in,
+                        std::span<Vec3T<T>> out) const;
+
+  const Mat3T<T>& Matrix() const { return matrix_; }
+  const Vec3T<T>& Offset() const { return offset_; }
+
+ private:
+  Mat3T<T> matrix_ = Mat3T<T>::Identity();
+  Vec3T<T> offset_ = {0, 0, 0};
+};
+
+using Rotation = RotationT<double>;
+using Rotationf = RotationT<float>;
+
+/**
+ * Rotates every point of `in` along axis `axis` by an angle `angle` around
+ * point `center` and writes them to `out`. Same as calling Rotate for each
+ * point, but the rotation is computed only once.
+ * `out` must be at least as big as `in`, `in` and `out` may be the same,
+ * precision is deduced from `axis`
  */
-Vec3 Rotate(const Vec3& point,
-            const Vec3& axis,
-            double angle,
-            const Vec3& center = {0, 0, 0});
+template <typename T>
+void RotateMany(std::span<const Vec3T<std::type_identity_t<T>>> in,
+                std::span<Vec3T<std::type_identity_t<T>>> out,
+                const Vec3T<T>& axis,
+                std::type_identity_t<T> angle,
+                const Vec3T<T>& center = {0, 0, 0});
+
+// defined for float and double in rotation.cc
+extern template Vec3T<float> Rotate(const Vec3T<float>&,
+                                    const Vec3T<float>&,
+                                    float,
+                                    const Vec3T<float>&);
+extern template Vec3T<double> Rotate(const Vec3T<double>&,
+                                     const Vec3T<double>&,
+                                     double,
+                                     const Vec3T<double>&);
+extern template class RotationT<float>;
+extern template class RotationT<double>;
+extern template void RotateMany(std::span<const Vec3T<float>>,
+                                std::span<Vec3T<float>>,
+                                const Vec3T<float>&,
+                                float,
+                                const Vec3T<float>&);
+extern template void RotateMany(std::span<const Vec3T<double>>,
+                                std::span<Vec3T<double>>,
+                                const Vec3T<double>&,
+                                double,
+                                const Vec3T<double>&);
 
 }  // namespace core
 
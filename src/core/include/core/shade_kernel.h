@@ -0,0 +1,108 @@
+#ifndef DONUTCPP_CORE_SHADE_KERNEL_H_
+#define DONUTCPP_CORE_SHADE_KERNEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "mat3.h"
+#include "point_cloud.h"
+#include "vec3.h"
+
+namespace core {
+
+enum SimdLevel {
+  kSimdScalar = 0,
+  kSimdSse2,
+  kSimdAvx2,
+  kSimdAvx512,
+};
+
+// best instruction set supported by the running cpu, detected once
+SimdLevel DetectSimdLevel();
+const char* SimdLevelToString(SimdLevel level);
+
+enum LightingMode {
+  // every normal is rotated by the matrix and dotted with the light
+  kLightingWorldSpace = 0,
+  // the light is rotated once by the inverse matrix and dotted with the
+  // untransformed normals, the matrix must be a rotation
+  kLightingObjectSpace,
+};
+
+/**
+ * Parameters of the per-point transform and shade pass.
+ * A point `p` with normal `n` ends up at
+ *   screen = matrix * p + offset, screen.x /= aspect_ratio
+ * and is lit by dot(light, matrix * n) clamped to [0, 1] and mapped to one of
+ * `light_level_count` glyphs.
+ */
+struct ShadeParams {
+  Mat3 matrix = Mat3::Identity();
+  Vec3 offset = {0, 0, 0};
+  double aspect_ratio = 1.0;
+  Vec3 light = {0, 0, 1};
+  int light_level_count = 1;
+  int width = 0;
+  int height = 0;
+  LightingMode lighting = kLightingWorldSpace;
+  // marks on screen points whose rotated normal points away from the viewer
+  // (negative z) as kCellCulled, the surface must be closed and dense enough
+  // that no back face shows between its points
+  bool cull_back_faces = false;
+};
+
+// `ShadeOutput::cell` values of points that must not be drawn
+inline constexpr int32_t kCellOffScreen = -1;
+inline constexpr int32_t kCellCulled = -2;
+
+/**
+ * Per-point results, element 0 of every span belongs to the first processed
+ * point and every span must be at least as big as the processed point range.
+ * `cell` is the screen buffer index, kCellOffScreen or kCellCulled,
+ * `depth` is the z coordinate for depth testing, `glyph` is the light level.
+ */
+struct ShadeOutput {
+  std::span<int32_t> cell;
+  std::span<double> depth;
+  std::span<uint8_t> glyph;
+};
+
+/**
+ * Transforms, projects and shades points [begin, end) of `points` using the
+ * vector instructions of `level` (2-8 doubles or 4-16 floats per register).
+ * The math runs in the precision of the cloud, `params` are converted once
+ * per call. Every level produces the same results as kSimdScalar.
+ */
+template <typename T>
+void TransformAndShade(const PointCloudT<T>& points,
+                       std::size_t begin,
+                       std::size_t end,
+                       const ShadeParams& params,
+                       const ShadeOutput& out,
+                       SimdLevel level = DetectSimdLevel());
+
+template <typename T>
+inline void TransformAndShade(const PointCloudT<T>& points,
+                              const ShadeParams& params,
+                              const ShadeOutput& out,
+                              SimdLevel level = DetectSimdLevel()) {
+  TransformAndShade(points, 0, points.Size(), params, out, level);
+}
+
+extern template void TransformAndShade(const PointCloudT<float>&,
+                                       std::size_t,
+                                       std::size_t,
+                                       const ShadeParams&,
+                                       const ShadeOutput&,
+                                       SimdLevel);
+extern template void TransformAndShade(const PointCloudT<double>&,
+                                       std::size_t,
+                                       std::size_t,
+                                       const ShadeParams&,
+                                       const ShadeOutput&,
+                                       SimdLevel);
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_SHADE_KERNEL_H_
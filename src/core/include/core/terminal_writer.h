@@ -0,0 +1,59 @@
+#ifndef DONUTCPP_CORE_TERMINAL_WRITER_H_
+#define DONUTCPP_CORE_TERMINAL_WRITER_H_
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "result.h"
+
+namespace core {
+
+/**
+ * Output to a terminal file descriptor without iostream or stdio buffering.
+ * Bytes are either appended to one preallocated buffer and sent by Flush, or
+ * sent in place by Write. Either way every call hands all of its bytes to a
+ * single write(2)/writev(2) and only issues more on partial writes.
+ * A non-blocking descriptor that is full (EAGAIN) is waited on with poll(2).
+ */
+class TerminalWriter {
+ public:
+  explicit TerminalWriter(int fd = STDOUT_FILENO, std::size_t capacity = 0);
+
+  TerminalWriter(const TerminalWriter&) = delete;
+  TerminalWriter& operator=(const TerminalWriter&) = delete;
+
+  // preallocates the buffer so Append doesn't allocate up to `capacity`
+  void Reserve(std::size_t capacity);
+  inline void Append(std::string_view bytes) { buffer_.append(bytes); }
+  inline std::string_view Buffered() const { return buffer_; }
+
+  // writes and empties the buffer
+  Result Flush();
+  // writes `bytes` without copying them into the buffer
+  Result Write(std::string_view bytes);
+  // writes every part in order with one writev
+  Result Write(std::span<const std::string_view> parts);
+
+  // write(2)/writev(2) calls made so far
+  inline int64_t Syscalls() const { return syscalls_; }
+
+ private:
+  // blocks until `fd_` can take more bytes
+  Result WaitWritable() const;
+
+  int fd_;
+  std::string buffer_;
+  std::vector<iovec> iov_;
+  int64_t syscalls_ = 0;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_TERMINAL_WRITER_H_
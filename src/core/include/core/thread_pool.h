@@ -0,0 +1,58 @@
+#ifndef DONUTCPP_CORE_THREAD_POOL_H_
+#define DONUTCPP_CORE_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace core {
+
+/**
+ * Fixed set of worker threads that run batches of indexed tasks.
+ * The thread calling ParallelFor works on the batch too.
+ */
+class ThreadPool {
+ public:
+  /**
+   * @param thread_count amount of threads including the calling one,
+   * 0 means one per hardware thread
+   */
+  explicit ThreadPool(int thread_count = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool(ThreadPool&&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ThreadPool& operator=(ThreadPool&&) = delete;
+
+  // amount of threads working on a batch, including the calling one
+  int Size() const;
+
+  // runs `task(i)` for every i in [0, task_count), returns when all are done
+  void ParallelFor(int task_count, const std::function<void(int)>& task);
+
+ private:
+  void WorkerLoop();
+  void RunTasks();
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  uint64_t generation_ = 0;
+  int busy_workers_ = 0;
+  bool stopping_ = false;
+
+  const std::function<void(int)>* task_ = nullptr;
+  int task_count_ = 0;
+  std::atomic<int> next_task_ = 0;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_THREAD_POOL_H_
@@ -5,15 +5,16 @@
 
 namespace core {
 
-struct Vec3 {
+template <typename T>
+struct Vec3T {
  public:
-  double x;
-  double y;
-  double z;
+  T x;
+  T y;
+  T z;
 
-  inline Vec3 Normalized() const {
-    double length = sqrt(x * x + y * y + z * z);
-    return Vec3{
+  inline Vec3T Normalized() const {
+    T length = std::sqrt(x * x + y * y + z * z);
+    return Vec3T{
         .x = x / length,
         .y = y / length,
         .z = z / length,
@@ -21,16 +22,24 @@ struct Vec3 {
   };
   inline void Normalize() { *this = Normalized(); }
 
-  inline Vec3 operator+(const Vec3& other) const {
+  // converts to a vector of another precision
+  template <typename U>
+  inline Vec3T<U> As() const {
+    return Vec3T<U>{(U)x, (U)y, (U)z};
+  }
+
+  inline Vec3T operator+(const Vec3T& other) const {
     return {x + other.x, y + other.y, z + other.z};
   }
-  inline Vec3& operator+=(const Vec3& other) {
+  inline Vec3T& operator+=(const Vec3T& other) {
     *this = *this + other;
     return *this;
   }
-  inline Vec3 operator-() const { return Vec3{-x, -y, -z}; }
-  inline Vec3 operator-(const Vec3& other) const { return *this + (-other); }
-  inline Vec3& operator-=(const Vec3& other) {
+  inline Vec3T operator-() const { return Vec3T{-x, -y, -z}; }
+  inline Vec3T operator-(const Vec3T& other) const {
+    return *this + (-other);
+  }
+  inline Vec3T& operator-=(const Vec3T& other) {
     *this = *this - other;
     return *this;
   }
@@ -40,11 +49,14 @@ struct Vec3 {
              std::isnan(z) || std::isinf(z));
   }
 
-  inline double Dot(const Vec3& other) const {
+  inline T Dot(const Vec3T& other) const {
     return x * other.x + y * other.y + z * other.z;
   }
 };
 
+using Vec3 = Vec3T<double>;
+using Vec3f = Vec3T<float>;
+
 }  // namespace core
 
 #endif  // DONUTCPP_CORE_VEC3_H_
@@ -2,27 +2,106 @@
 #define DONUTCPP_CORE_VULKAN_RENDERER_H_
 
 #include <chrono>
+#include <cstdint>
 #include <expected>
 #include <memory>
+#include <memory_resource>
+#include <span>
 
+#include "core/frame_pacer.h"
+#include "core/frame_stats.h"
 #include "core/result.h"
 #include "core/vec3.h"
 
 namespace core {
 
+class EpochFramebuffer;
+class FrameSink;
+class Framebuffer;
+class PackedFramebuffer;
+struct PresentStats;
 class VulkanRenderer;
 
 class VulkanRenderHandler {
  public:
   virtual ~VulkanRenderHandler() = default;
   virtual void Render(double delta, VulkanRenderer& renderer) = 0;
+  // points the last Render transformed, for BatchReport
+  virtual int64_t LastPointCount() const { return 0; }
+};
+
+enum FramebufferMode {
+  // separate char and depth buffers (Framebuffer), puts are single-threaded
+  kFramebufferDepth = 0,
+  // depth and char packed in one word (PackedFramebuffer), puts are
+  // thread-safe
+  kFramebufferPacked,
+  // cells stamped with the frame they were written in (EpochFramebuffer),
+  // Clear is O(1), puts are single-threaded
+  kFramebufferEpoch,
+};
+
+enum PresentMode {
+  // frames are written to the terminal by the render thread
+  kPresentInline = 0,
+  // a presenter thread writes frame N while the render thread draws N + 1,
+  // frames it can't keep up with are dropped
+  kPresentThread,
+};
+
+enum BackendMode {
+  // GLFW window with a vulkan device, frames are drawn to the terminal
+  kBackendVulkan = 0,
+  // frames are only kept in memory, needs no display, GPU or terminal
+  kBackendHeadless,
 };
 
 struct VulkanRendererConfig {
   int width = 0;
   int height = 0;
+  // 0 renders as fast as possible
   int target_fps = 0;
+  // busy-waits this long before a frame is due instead of sleeping
+  int spin_us = 200;
+  OverrunPolicy overrun_policy = kOverrunCatchUp;
+  // frames to render before Start returns, 0 means until the window is closed
+  // or Stop is called
+  int64_t max_frames = 0;
+  BackendMode backend = kBackendVulkan;
+  // frame stats are written there at the end of Start and on SIGUSR1
+  const char* frame_stats_path = nullptr;
+  StatsFormat frame_stats_format = kStatsJson;
+  // gets every rendered frame too, e.g. a FrameRecorder, on the render
+  // thread, so frames the presenter thread drops are still recorded
+  FrameSink* recorder = nullptr;
+  FramebufferMode framebuffer_mode = kFramebufferDepth;
+  PresentMode present_mode = kPresentInline;
   VulkanRenderHandler* render_handler = nullptr;
+  // where the framebuffer is allocated, nullptr for the default resource;
+  // has to outlive the renderer
+  std::pmr::memory_resource* memory_resource = nullptr;
+};
+
+struct BatchConfig {
+  int64_t frames = 0;
+  // simulated seconds between frames passed to Render
+  double delta = 0.0;
+  // nullptr drops the frames
+  FrameSink* sink = nullptr;
+};
+
+struct BatchReport {
+  int64_t frames = 0;
+  // sum of VulkanRenderHandler::LastPointCount over the frames
+  int64_t points = 0;
+  std::chrono::nanoseconds elapsed{0};
+
+  inline double FramesPerSecond() const {
+    return elapsed.count() ? frames * 1e9 / elapsed.count() : 0.0;
+  }
+  inline double NsPerPoint() const {
+    return points ? elapsed.count() / (double)points : 0.0;
+  }
 };
 
 class VulkanRenderer {
@@ -32,6 +111,18 @@ class VulkanRenderer {
   ~VulkanRenderer();
 
   void Start();
+  // makes Start return after the current frame, can be called from Render
+  void Stop();
+  /**
+   * renders `config.frames` frames as fast as possible, with a fixed delta,
+   * without pacing, polling events or presenting, into `config.sink`
+   */
+  std::expected<BatchReport, Result> RenderBatch(const BatchConfig& config);
+  /**
+   * ends the running stage of the frame and starts `stage`, lets Render tell
+   * kStageSimulate from kStageRaster
+   */
+  void BeginStage(FrameStage stage);
 
   void Clear();
   // puts a char `sym` on the screen at a point (x, y), doesn't check bounds
@@ -44,6 +135,38 @@ class VulkanRenderer {
    */
   void Put(const core::Vec3& point, char sym);
 
+  /**
+   * puts a char `sym` at buffer index `index` if `depth` is closer than what
+   * is already there, doesn't check bounds
+   */
+  void PutAt(int index, double depth, char sym);
+  // PutAt for `length` cells from `index` on, one framebuffer switch per run
+  void PutRun(int index, int length, double depth, char sym);
+
+  // resolves what was put so far into the chars that will be presented
+  std::span<const char> ResolveChars();
+
+  // screen buffer that Put writes to in kFramebufferDepth mode
+  Framebuffer& GetFramebuffer();
+  // screen buffer that Put writes to in kFramebufferPacked mode
+  PackedFramebuffer& GetPackedFramebuffer();
+  // screen buffer that Put writes to in kFramebufferEpoch mode
+  EpochFramebuffer& GetEpochFramebuffer();
+  FramebufferMode GetFramebufferMode() const;
+  /**
+   * terminal output of the drawn frames, in kPresentThread mode it is only
+   * consistent after Start returns
+   */
+  const PresentStats& GetPresentStats() const;
+  // rendered frames that were never presented, always 0 in kPresentInline
+  int64_t GetDroppedFrames() const;
+  // per stage frame durations since New, same consistency as GetPresentStats
+  const FrameStats& GetFrameStats() const;
+  // how closely frames kept to target_fps, same consistency as GetFrameStats
+  const PacerStats& GetPacerStats() const;
+  // the last frame handed to the backend, same consistency as GetPresentStats
+  std::span<const char> GetPresentedFrame() const;
+
   int GetWidth() const;
   int GetHeight() const;
   double GetRatio() const;
@@ -62,7 +185,7 @@ class VulkanRenderer {
   struct Impl;
   std::unique_ptr<Impl> d;
 
-  VulkanRenderer();
+  explicit VulkanRenderer(std::pmr::memory_resource* resource);
 };
 
 }  // namespace core
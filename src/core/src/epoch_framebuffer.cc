@@ -0,0 +1,47 @@
+#include "core/epoch_framebuffer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+
+namespace core {
+
+EpochFramebuffer::EpochFramebuffer(int width, int height) {
+  Resize(width, height);
+}
+
+void EpochFramebuffer::Resize(int width, int height) {
+  width_ = width;
+  height_ = height;
+  epoch_ = 1;
+  cells_.assign(width * height, Cell{.depth = 0.0, .epoch = 0, .sym = ' '});
+  rows_.assign(height, EmptySpan());
+  resolved_.assign(height, EmptySpan());
+}
+
+void EpochFramebuffer::Clear() {
+  ++epoch_;
+  // stamps from 2^32 frames ago would look current again
+  if (epoch_ == 0) {
+    std::fill(cells_.begin(), cells_.end(),
+              Cell{.depth = 0.0, .epoch = 0, .sym = ' '});
+    std::fill(rows_.begin(), rows_.end(), EmptySpan());
+    epoch_ = 1;
+  }
+}
+
+void EpochFramebuffer::ResolveChars(std::span<char> target) {
+  for (int y = 0; y < height_; ++y) {
+    const Span current = rows_[y].epoch == epoch_ ? rows_[y] : EmptySpan();
+    Span& last = resolved_[y];
+    // cells between the two spans that weren't put into read as ' '
+    const int row = y * width_;
+    const int end = row + std::max(current.end, last.end);
+    for (int i = row + std::min(current.begin, last.begin); i < end; ++i) {
+      target[i] = CharAt(i);
+    }
+    last = current;
+  }
+}
+
+}  // namespace core
@@ -0,0 +1,93 @@
+#include "core/frame_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace core {
+
+FrameCache::FrameCache(std::size_t budget_bytes) : budget_(budget_bytes) {}
+
+void FrameCache::SetBudget(std::size_t budget_bytes) {
+  budget_ = budget_bytes;
+  EvictToBudget();
+}
+
+void FrameCache::Clear() {
+  lru_.clear();
+  entries_.clear();
+  stats_.bytes = 0;
+  stats_.entries = 0;
+}
+
+void FrameCache::Insert(uint64_t key, std::span<const char> frame) {
+  if (const auto found = entries_.find(key); found != entries_.end()) {
+    Erase(found->second);
+  }
+
+  std::vector<uint8_t> runs;
+  for (std::size_t i = 0; i < frame.size();) {
+    const char sym = frame[i];
+    std::size_t length = 1;
+    while (i + length < frame.size() && frame[i + length] == sym) {
+      ++length;
+    }
+    i += length;
+
+    runs.push_back(sym);
+    for (; length >= 0x80; length >>= 7) {
+      runs.push_back((length & 0x7f) | 0x80);
+    }
+    runs.push_back(length);
+  }
+  runs.shrink_to_fit();
+
+  const std::size_t bytes = runs.size() + kEntryOverhead;
+  if (bytes > budget_) {
+    return;
+  }
+  lru_.push_front(Entry{.key = key, .runs = std::move(runs)});
+  entries_[key] = lru_.begin();
+  stats_.bytes += bytes;
+  ++stats_.entries;
+  EvictToBudget();
+}
+
+bool FrameCache::Lookup(uint64_t key, std::span<char> out) {
+  return Visit(key, [&](int index, int length, char sym) {
+    std::memset(out.data() + index, sym, length);
+  });
+}
+
+const std::vector<uint8_t>* FrameCache::Find(uint64_t key) {
+  const auto found = entries_.find(key);
+  if (found == entries_.end()) {
+    ++stats_.misses;
+    return nullptr;
+  }
+
+  ++stats_.hits;
+  lru_.splice(lru_.begin(), lru_, found->second);
+  return &found->second->runs;
+}
+
+void FrameCache::Erase(std::list<Entry>::iterator entry) {
+  stats_.bytes -= entry->runs.size() + kEntryOverhead;
+  --stats_.entries;
+  entries_.erase(entry->key);
+  lru_.erase(entry);
+}
+
+void FrameCache::EvictToBudget() {
+  while (stats_.bytes > budget_ && !lru_.empty()) {
+    Erase(std::prev(lru_.end()));
+    ++stats_.evictions;
+  }
+}
+
+}  // namespace core
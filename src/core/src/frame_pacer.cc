@@ -0,0 +1,64 @@
+#include "core/frame_pacer.h"
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace core {
+
+FramePacer::FramePacer(std::chrono::nanoseconds period,
+                       std::chrono::nanoseconds spin,
+                       OverrunPolicy policy)
+    : period_(period), spin_(spin), policy_(policy) {}
+
+void FramePacer::Start(Clock::time_point now) {
+  frame_begin_ = now;
+  deadline_ = now + period_;
+}
+
+double FramePacer::Wait() {
+  Clock::time_point now = Clock::now();
+
+  if (period_.count() > 0) {
+    if (now >= deadline_) {
+      ++stats_.overruns;
+      const int64_t behind = (now - deadline_) / period_;
+      if (policy_ == kOverrunSkip) {
+        deadline_ += (behind + 1) * period_;
+        stats_.skipped += behind + 1;
+      } else if (behind >= kMaxCatchUpFrames) {
+        deadline_ = now;
+        stats_.skipped += behind;
+      }
+    }
+    if (now < deadline_) {
+      now = SleepUntil(deadline_);
+      stats_.wake_error.Record(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(now - deadline_)
+              .count());
+    }
+    deadline_ += period_;
+  }
+
+  const std::chrono::nanoseconds interval =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - frame_begin_);
+  stats_.intervals.Record(interval.count());
+  frame_begin_ = now;
+  return std::chrono::duration<double>(interval).count();
+}
+
+FramePacer::Clock::time_point FramePacer::SleepUntil(
+    Clock::time_point deadline) const {
+  if (Clock::now() < deadline - spin_) {
+    std::this_thread::sleep_until(deadline - spin_);
+  }
+
+  Clock::time_point now = Clock::now();
+  while (now < deadline) {
+    std::this_thread::yield();
+    now = Clock::now();
+  }
+  return now;
+}
+
+}  // namespace core
@@ -0,0 +1,424 @@
+#include "core/frame_recorder.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <expected>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "core/result.h"
+
+namespace core {
+
+namespace {
+
+// delta runs closer than this are merged, a run header costs 8 bytes
+constexpr int kRunMergeGap = 8;
+
+std::size_t AlignUp(std::size_t value) {
+  return (value + 7) & ~std::size_t{7};
+}
+
+}  // namespace
+
+std::expected<FrameRecorder*, Result> FrameRecorder::New(
+    const char* path,
+    const RecorderConfig& config) {
+  const int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return std::unexpected(FileError{path});
+  }
+  std::unique_ptr<FrameRecorder> recorder(new FrameRecorder(fd, path, config));
+
+  if (config.format == kRecordAsciicast) {
+    char header[128];
+    const int length = std::snprintf(
+        header, sizeof(header),
+        "{\"version\": 2, \"width\": %d, \"height\": %d}\n", config.width,
+        config.height);
+    TRY_RS(recorder->Reserve(length));
+    recorder->Append(header, length);
+  } else {
+    RecordingHeader header = {
+        .magic = {},
+        .width = (uint32_t)config.width,
+        .height = (uint32_t)config.height,
+        .format = (uint32_t)config.format,
+        .keyframe_interval = (uint32_t)std::max(config.keyframe_interval, 1),
+        .index_offset = 0,
+    };
+    std::memcpy(header.magic, kRecordingMagic, sizeof(header.magic));
+    TRY_RS(recorder->Reserve(sizeof(header)));
+    recorder->Append(&header, sizeof(header));
+  }
+
+  return recorder.release();
+}
+
+FrameRecorder::FrameRecorder(int fd,
+                             const char* path,
+                             const RecorderConfig& config)
+    : fd_(fd),
+      path_(path),
+      cfg_(config),
+      previous_(config.width * config.height, ' '),
+      presenter_(config.width, config.height),
+      start_(std::chrono::steady_clock::now()) {
+  cfg_.keyframe_interval = std::max(cfg_.keyframe_interval, 1);
+  cfg_.chunk_size = std::max<std::size_t>(cfg_.chunk_size, 1 << 16);
+}
+
+FrameRecorder::~FrameRecorder() {
+  Finish();
+}
+
+Result FrameRecorder::Consume(std::span<const char> frame) {
+  if (frame.size() != previous_.size()) {
+    return kRecordingFailed;
+  }
+  const uint64_t time_ns = FrameTimeNs();
+  const bool key = offsets_.size() % cfg_.keyframe_interval == 0;
+
+  switch (cfg_.format) {
+    case kRecordRaw:
+      TRY_RS_ERR(Reserve(sizeof(RecordHeader) + AlignUp(frame.size())));
+      AppendKey(frame, time_ns);
+      break;
+    case kRecordRawDelta:
+      // the worst delta that is still kept is smaller than a key frame
+      TRY_RS_ERR(Reserve(sizeof(RecordHeader) + AlignUp(frame.size())));
+      if (key || !AppendDelta(frame, time_ns)) {
+        AppendKey(frame, time_ns);
+      }
+      std::memcpy(previous_.data(), frame.data(), previous_.size());
+      break;
+    case kRecordAsciicast: {
+      if (key) {
+        presenter_.Invalidate();
+      }
+      const std::string_view output = presenter_.Present(frame);
+      // every byte escapes to at most 6 ("\u001b"), plus the brackets
+      TRY_RS_ERR(Reserve(output.size() * 6 + 64));
+      AppendAsciicastEvent(output, time_ns);
+      break;
+    }
+  }
+  return Result();
+}
+
+Result FrameRecorder::Finish() {
+  if (finished_) {
+    return Result();
+  }
+  finished_ = true;
+
+  Result result;
+  if (cfg_.format == kRecordAsciicast) {
+    const std::string index_path = path_ + ".idx";
+    const int fd = open(index_path.c_str(),
+                        O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+      result = kRecordingFailed;
+    } else {
+      result = WriteIndex(fd, 0);
+      close(fd);
+    }
+  } else {
+    size_ = AlignUp(size_);
+    const uint64_t index_offset = size_;
+    result = WriteIndex(fd_, index_offset);
+    size_ += sizeof(uint64_t) * (offsets_.size() + 1);
+    if (result && data_) {
+      std::memcpy(data_ + offsetof(RecordingHeader, index_offset),
+                  &index_offset, sizeof(index_offset));
+    }
+  }
+
+  if (data_) {
+    munmap(data_, capacity_);
+    data_ = nullptr;
+  }
+  if (ftruncate(fd_, size_) != 0) {
+    result = kRecordingFailed;
+  }
+  close(fd_);
+  return result;
+}
+
+Result FrameRecorder::Reserve(std::size_t bytes) {
+  if (size_ + bytes <= capacity_) {
+    return Result();
+  }
+
+  const std::size_t chunks = (size_ + bytes - capacity_ + cfg_.chunk_size - 1) /
+                             cfg_.chunk_size;
+  const std::size_t capacity = capacity_ + chunks * cfg_.chunk_size;
+  if (ftruncate(fd_, capacity) != 0) {
+    return kRecordingFailed;
+  }
+
+  void* data = data_ ? mremap(data_, capacity_, capacity, MREMAP_MAYMOVE)
+                      : mmap(nullptr, capacity, PROT_READ | PROT_WRITE,
+                             MAP_SHARED, fd_, 0);
+  if (data == MAP_FAILED) {
+    return kRecordingFailed;
+  }
+  data_ = (char*)data;
+  capacity_ = capacity;
+  return Result();
+}
+
+void FrameRecorder::Append(const void* bytes, std::size_t count) {
+  std::memcpy(data_ + size_, bytes, count);
+  size_ += count;
+}
+
+uint64_t FrameRecorder::FrameTimeNs() {
+  if (cfg_.frame_interval > 0.0) {
+    return offsets_.size() * cfg_.frame_interval * 1e9;
+  }
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - start_)
+      .count();
+}
+
+void FrameRecorder::AppendKey(std::span<const char> frame, uint64_t time_ns) {
+  offsets_.push_back(size_);
+  const RecordHeader header = {
+      .time_ns = time_ns,
+      .payload_size = (uint32_t)frame.size(),
+      .kind = kRecordKey,
+  };
+  Append(&header, sizeof(header));
+  Append(frame.data(), frame.size());
+  size_ = AlignUp(size_);
+}
+
+bool FrameRecorder::AppendDelta(std::span<const char> frame,
+                                uint64_t time_ns) {
+  const std::size_t record = size_;
+  const std::size_t limit = record + sizeof(RecordHeader) + frame.size();
+  std::size_t out = record + sizeof(RecordHeader);
+  const char* now = frame.data();
+  const char* before = previous_.data();
+  const uint32_t cells = frame.size();
+
+  uint32_t cell = 0;
+  while (cell < cells) {
+    // most of a frame is unchanged, skip it a word at a time
+    if (cell + sizeof(uint64_t) <= cells &&
+        std::memcmp(now + cell, before + cell, sizeof(uint64_t)) == 0) {
+      cell += sizeof(uint64_t);
+      continue;
+    }
+    if (now[cell] == before[cell]) {
+      ++cell;
+      continue;
+    }
+    // extend the run over short unchanged gaps
+    const uint32_t begin = cell;
+    uint32_t end = cell + 1;
+    uint32_t same = 0;
+    for (uint32_t i = end; i < cells && same < kRunMergeGap; ++i) {
+      if (now[i] != before[i]) {
+        end = i + 1;
+        same = 0;
+      } else {
+        ++same;
+      }
+    }
+
+    const uint32_t length = end - begin;
+    if (out + 2 * sizeof(uint32_t) + length >= limit) {
+      return false;
+    }
+    std::memcpy(data_ + out, &begin, sizeof(begin));
+    std::memcpy(data_ + out + sizeof(begin), &length, sizeof(length));
+    std::memcpy(data_ + out + 2 * sizeof(uint32_t), now + begin, length);
+    out += 2 * sizeof(uint32_t) + length;
+    cell = end;
+  }
+
+  const RecordHeader header = {
+      .time_ns = time_ns,
+      .payload_size = (uint32_t)(out - record - sizeof(RecordHeader)),
+      .kind = kRecordDelta,
+  };
+  std::memcpy(data_ + record, &header, sizeof(header));
+  offsets_.push_back(record);
+  size_ = AlignUp(out);
+  return true;
+}
+
+void FrameRecorder::AppendAsciicastEvent(std::string_view output,
+                                         uint64_t time_ns) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  offsets_.push_back(size_);
+
+  char prefix[48];
+  const int length = std::snprintf(prefix, sizeof(prefix), "[%.6f, \"o\", \"",
+                                   time_ns / 1e9);
+  Append(prefix, length);
+
+  char* out = data_ + size_;
+  for (const char c : output) {
+    if (c == '"' || c == '\\') {
+      *out++ = '\\';
+      *out++ = c;
+    } else if ((unsigned char)c < 0x20 || c == 0x7f) {
+      std::memcpy(out, "\\u00", 4);
+      out[4] = kHex[(unsigned char)c >> 4];
+      out[5] = kHex[c & 0xf];
+      out += 6;
+    } else {
+      *out++ = c;
+    }
+  }
+  size_ = out - data_;
+  Append("\"]\n", 3);
+}
+
+Result FrameRecorder::WriteIndex(int fd, uint64_t offset) {
+  const uint64_t count = offsets_.size();
+  if (pwrite(fd, &count, sizeof(count), offset) != sizeof(count)) {
+    return kRecordingFailed;
+  }
+
+  const std::size_t bytes = offsets_.size() * sizeof(uint64_t);
+  std::size_t written = 0;
+  while (written < bytes) {
+    const ssize_t result =
+        pwrite(fd, (const char*)offsets_.data() + written, bytes - written,
+               offset + sizeof(count) + written);
+    if (result <= 0) {
+      return kRecordingFailed;
+    }
+    written += result;
+  }
+  return Result();
+}
+
+std::expected<RecordingReader*, Result> RecordingReader::New(
+    const char* path) {
+  const int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return std::unexpected(FileError{path});
+  }
+  struct stat file_stat = {};
+  if (fstat(fd, &file_stat) != 0) {
+    close(fd);
+    return std::unexpected(FileError{path});
+  }
+
+  std::unique_ptr<RecordingReader> reader(new RecordingReader);
+  reader->size_ = file_stat.st_size;
+  void* data = reader->size_ >= sizeof(RecordingHeader)
+                   ? mmap(nullptr, reader->size_, PROT_READ, MAP_SHARED, fd, 0)
+                   : MAP_FAILED;
+  close(fd);
+  if (data == MAP_FAILED) {
+    reader->size_ = 0;
+    return std::unexpected(kInvalidRecording);
+  }
+  reader->data_ = (const char*)data;
+
+  RecordingHeader& header = reader->header_;
+  std::memcpy(&header, reader->data_, sizeof(header));
+  const uint64_t frame_size = (uint64_t)header.width * header.height;
+  if (std::memcmp(header.magic, kRecordingMagic, sizeof(header.magic)) != 0 ||
+      header.index_offset < sizeof(RecordingHeader) ||
+      header.index_offset % 8 != 0 ||
+      header.index_offset + sizeof(uint64_t) > reader->size_) {
+    return std::unexpected(kInvalidRecording);
+  }
+
+  std::memcpy(&reader->frame_count_, reader->data_ + header.index_offset,
+              sizeof(uint64_t));
+  reader->offsets_ =
+      (const uint64_t*)(reader->data_ + header.index_offset + sizeof(uint64_t));
+  if (reader->frame_count_ < 0 ||
+      (uint64_t)reader->frame_count_ >
+          (reader->size_ - header.index_offset) / sizeof(uint64_t) - 1) {
+    return std::unexpected(kInvalidRecording);
+  }
+  for (int64_t i = 0; i < reader->frame_count_; ++i) {
+    const uint64_t offset = reader->offsets_[i];
+    if (offset % 8 != 0 ||
+        offset + sizeof(RecordHeader) > header.index_offset ||
+        offset + sizeof(RecordHeader) + reader->RecordAt(i).payload_size >
+            header.index_offset ||
+        (reader->RecordAt(i).kind == kRecordKey &&
+         reader->RecordAt(i).payload_size != frame_size)) {
+      return std::unexpected(kInvalidRecording);
+    }
+  }
+
+  return reader.release();
+}
+
+RecordingReader::~RecordingReader() {
+  if (data_) {
+    munmap((void*)data_, size_);
+  }
+}
+
+const RecordHeader& RecordingReader::RecordAt(int64_t index) const {
+  return *(const RecordHeader*)(data_ + offsets_[index]);
+}
+
+uint64_t RecordingReader::FrameTimeNs(int64_t index) const {
+  return RecordAt(index).time_ns;
+}
+
+Result RecordingReader::ReadFrame(int64_t index, std::span<char> out) const {
+  const std::size_t frame_size = (std::size_t)header_.width * header_.height;
+  if (index < 0 || index >= frame_count_ || out.size() < frame_size) {
+    return kInvalidRecording;
+  }
+
+  int64_t key = index;
+  while (RecordAt(key).kind != kRecordKey) {
+    if (key == 0) {
+      return kInvalidRecording;
+    }
+    --key;
+  }
+
+  for (int64_t i = key; i <= index; ++i) {
+    const RecordHeader& record = RecordAt(i);
+    const char* payload = (const char*)&record + sizeof(RecordHeader);
+    if (record.kind == kRecordKey) {
+      std::memcpy(out.data(), payload, frame_size);
+      continue;
+    }
+
+    const char* end = payload + record.payload_size;
+    while (payload + 2 * sizeof(uint32_t) <= end) {
+      uint32_t begin;
+      uint32_t length;
+      std::memcpy(&begin, payload, sizeof(begin));
+      std::memcpy(&length, payload + sizeof(begin), sizeof(length));
+      payload += 2 * sizeof(uint32_t);
+      if (length > (std::size_t)(end - payload) ||
+          (std::size_t)begin + length > frame_size) {
+        return kInvalidRecording;
+      }
+      std::memcpy(out.data() + begin, payload, length);
+      payload += length;
+    }
+  }
+  return Result();
+}
+
+}  // namespace core
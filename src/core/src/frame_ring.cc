@@ -0,0 +1,64 @@
+#include "core/frame_ring.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace core {
+
+FrameRing::FrameRing(int frame_size) {
+  Resize(frame_size);
+}
+
+void FrameRing::Resize(int frame_size) {
+  for (std::vector<char>& slot : slots_) {
+    slot.assign(frame_size, ' ');
+  }
+  back_ = 0;
+  front_ = 2;
+  latest_.store(1, std::memory_order_relaxed);
+  closed_.store(false, std::memory_order_relaxed);
+}
+
+void FrameRing::Publish() {
+  const uint32_t previous =
+      latest_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+  back_ = previous & ~kFresh;
+  if (previous & kFresh) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  published_.fetch_add(1, std::memory_order_release);
+  published_.notify_one();
+}
+
+bool FrameRing::TryAcquire() {
+  if (!(latest_.load(std::memory_order_relaxed) & kFresh)) {
+    return false;
+  }
+  const uint32_t previous =
+      latest_.exchange(front_, std::memory_order_acq_rel);
+  front_ = previous & ~kFresh;
+  return true;
+}
+
+bool FrameRing::WaitAcquire() {
+  while (true) {
+    const int64_t seen = published_.load(std::memory_order_acquire);
+    if (TryAcquire()) {
+      return true;
+    }
+    if (closed_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    published_.wait(seen, std::memory_order_acquire);
+  }
+}
+
+void FrameRing::Close() {
+  closed_.store(true, std::memory_order_release);
+  published_.fetch_add(1, std::memory_order_release);
+  published_.notify_one();
+}
+
+}  // namespace core
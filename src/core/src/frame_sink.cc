@@ -0,0 +1,51 @@
+#include "core/frame_sink.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <string_view>
+
+#include "core/result.h"
+
+namespace core {
+
+Result NullSink::Consume(std::span<const char>) {
+  return Result();
+}
+
+MemorySink::MemorySink(std::size_t capacity) {
+  frames_.reserve(capacity);
+}
+
+Result MemorySink::Consume(std::span<const char> frame) {
+  frames_.insert(frames_.end(), frame.begin(), frame.end());
+  ++frame_count_;
+  return Result();
+}
+
+std::expected<FileSink*, Result> FileSink::New(const char* path) {
+  const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return std::unexpected(FileError{path});
+  }
+
+  return new FileSink(fd);
+}
+
+FileSink::FileSink(int fd) : fd_(fd), writer_(fd) {}
+
+FileSink::~FileSink() {
+  close(fd_);
+}
+
+Result FileSink::Consume(std::span<const char> frame) {
+  if (!writer_.Write(std::string_view(frame.data(), frame.size()))) {
+    return kFrameSinkWriteFailed;
+  }
+  return Result();
+}
+
+}  // namespace core
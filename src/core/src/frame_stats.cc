@@ -0,0 +1,103 @@
+#include "core/frame_stats.h"
+
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <ostream>
+
+#include "core/latency_histogram.h"
+#include "core/result.h"
+
+namespace core {
+
+namespace {
+
+const double kPercentiles[] = {50.0, 95.0, 99.0, 99.9};
+const char* const kPercentileNames[] = {"p50_ns", "p95_ns", "p99_ns",
+                                        "p999_ns"};
+
+void WriteJsonHistogram(std::ostream& out,
+                        const char* name,
+                        const LatencyHistogram& histogram) {
+  out << "\"" << name << "\": {\"count\": " << histogram.Count()
+      << ", \"min_ns\": " << histogram.Min()
+      << ", \"mean_ns\": " << (int64_t)histogram.Mean();
+  for (std::size_t i = 0; i < std::size(kPercentiles); ++i) {
+    out << ", \"" << kPercentileNames[i]
+        << "\": " << histogram.Percentile(kPercentiles[i]);
+  }
+  out << ", \"max_ns\": " << histogram.Max() << "}";
+}
+
+void WriteCsvHistogram(std::ostream& out,
+                       const char* name,
+                       const LatencyHistogram& histogram) {
+  out << name << ',' << histogram.Count() << ',' << histogram.Min() << ','
+      << (int64_t)histogram.Mean();
+  for (const double percent : kPercentiles) {
+    out << ',' << histogram.Percentile(percent);
+  }
+  out << ',' << histogram.Max() << '\n';
+}
+
+}  // namespace
+
+const char* FrameStageName(FrameStage stage) {
+  switch (stage) {
+    case kStageClear:
+      return "clear";
+    case kStageSimulate:
+      return "simulate";
+    case kStageRaster:
+      return "raster";
+    case kStagePresent:
+      return "present";
+    case kStageIdle:
+      return "idle";
+    case kFrameStageCount:
+      break;
+  }
+  return "unknown";
+}
+
+void FrameStats::Reset() {
+  for (LatencyHistogram& stage : stages) {
+    stage.Reset();
+  }
+  frames.Reset();
+}
+
+void FrameStats::Write(std::ostream& out, StatsFormat format) const {
+  switch (format) {
+    case kStatsJson:
+      out << "{";
+      WriteJsonHistogram(out, "frame", frames);
+      out << ",\n \"stages\": {";
+      for (int i = 0; i < kFrameStageCount; ++i) {
+        out << (i ? ",\n  " : "\n  ");
+        WriteJsonHistogram(out, FrameStageName((FrameStage)i), stages[i]);
+      }
+      out << "\n}}\n";
+      break;
+    case kStatsCsv:
+      out << "stage,count,min_ns,mean_ns,p50_ns,p95_ns,p99_ns,p999_ns,"
+             "max_ns\n";
+      WriteCsvHistogram(out, "frame", frames);
+      for (int i = 0; i < kFrameStageCount; ++i) {
+        WriteCsvHistogram(out, FrameStageName((FrameStage)i), stages[i]);
+      }
+      break;
+  }
+}
+
+Result FrameStats::WriteFile(const char* path, StatsFormat format) const {
+  std::ofstream file(path, std::ios::trunc);
+  if (!file.is_open()) {
+    return FileError{path};
+  }
+
+  Write(file, format);
+  return Result();
+}
+
+}  // namespace core
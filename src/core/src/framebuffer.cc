@@ -0,0 +1,30 @@
+#include "core/framebuffer.h"
+
+#include <algorithm>
+#include <memory_resource>
+
+namespace core {
+
+Framebuffer::Framebuffer(std::pmr::memory_resource* resource)
+    : chars_(resource), depths_(resource) {}
+
+Framebuffer::Framebuffer(int width,
+                         int height,
+                         std::pmr::memory_resource* resource)
+    : Framebuffer(resource) {
+  Resize(width, height);
+}
+
+void Framebuffer::Resize(int width, int height) {
+  width_ = width;
+  height_ = height;
+  chars_.assign(width * height, ' ');
+  depths_.assign(width * height, 0.0);
+}
+
+void Framebuffer::Clear() {
+  std::fill(chars_.begin(), chars_.end(), ' ');
+  std::fill(depths_.begin(), depths_.end(), 0.0);
+}
+
+}  // namespace core
@@ -0,0 +1,38 @@
+#include "headless_backend.h"
+
+#include <algorithm>
+#include <span>
+
+#include "core/presenter.h"
+#include "core/result.h"
+
+namespace core {
+
+HeadlessBackend::HeadlessBackend(int width, int height)
+    : frame_(width * height, ' ') {}
+
+bool HeadlessBackend::ShouldClose() {
+  return false;
+}
+
+void HeadlessBackend::PollEvents() {}
+
+Result HeadlessBackend::Present(std::span<const char> frame) {
+  std::ranges::copy(frame, frame_.begin());
+
+  ++stats_.frames;
+  ++stats_.full_redraws;
+  stats_.last_frame_bytes = frame.size();
+  stats_.total_bytes += frame.size();
+  return Result();
+}
+
+std::span<const char> HeadlessBackend::PresentedFrame() const {
+  return frame_;
+}
+
+const PresentStats& HeadlessBackend::Stats() const {
+  return stats_;
+}
+
+}  // namespace core
@@ -0,0 +1,35 @@
+#ifndef DONUTCPP_CORE_HEADLESS_BACKEND_H_
+#define DONUTCPP_CORE_HEADLESS_BACKEND_H_
+
+#include <span>
+#include <vector>
+
+#include "core/presenter.h"
+#include "core/result.h"
+
+#include "render_backend.h"
+
+namespace core {
+
+// keeps presented frames in memory, needs no display, GPU or terminal
+class HeadlessBackend : public RenderBackend {
+ public:
+  HeadlessBackend(int width, int height);
+
+  // never closes, the render loop is ended by VulkanRenderer::Stop or
+  // VulkanRendererConfig::max_frames
+  bool ShouldClose() override;
+  void PollEvents() override;
+  Result Present(std::span<const char> frame) override;
+
+  std::span<const char> PresentedFrame() const override;
+  const PresentStats& Stats() const override;
+
+ private:
+  std::vector<char> frame_;
+  PresentStats stats_;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_HEADLESS_BACKEND_H_
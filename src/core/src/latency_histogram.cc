@@ -0,0 +1,50 @@
+#include "core/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace core {
+
+void LatencyHistogram::Reset() {
+  *this = LatencyHistogram();
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) {
+  for (int i = 0; i < kBucketCount; ++i) {
+    buckets_[i] += other.buckets_[i];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+  min_ = std::min(min_, other.min_);
+  max_ = std::max(max_, other.max_);
+}
+
+int64_t LatencyHistogram::Percentile(double percent) const {
+  if (!count_) {
+    return 0;
+  }
+  const int64_t rank =
+      std::clamp<int64_t>(std::ceil(percent / 100.0 * count_), 1, count_);
+
+  int64_t seen = 0;
+  for (int i = 0; i < kBucketCount; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      return std::min<int64_t>(BucketEnd(i), max_);
+    }
+  }
+  return max_;
+}
+
+int64_t LatencyHistogram::BucketBegin(int bucket) {
+  const int shift = std::max(0, bucket / kSubBucketCount - 1);
+  return (int64_t)(bucket - shift * kSubBucketCount) << shift;
+}
+
+int64_t LatencyHistogram::BucketEnd(int bucket) {
+  const int shift = std::max(0, bucket / kSubBucketCount - 1);
+  return BucketBegin(bucket) + (int64_t{1} << shift) - 1;
+}
+
+}  // namespace core
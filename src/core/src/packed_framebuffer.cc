@@ -0,0 +1,37 @@
+#include "core/packed_framebuffer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "core/framebuffer.h"
+
+namespace core {
+
+PackedFramebuffer::PackedFramebuffer(int width, int height) {
+  Resize(width, height);
+}
+
+void PackedFramebuffer::Resize(int width, int height) {
+  width_ = width;
+  height_ = height;
+  cells_ = std::make_unique<std::atomic<uint32_t>[]>(width * height);
+  Clear();
+}
+
+void PackedFramebuffer::Clear() {
+  for (int i = 0; i < Size(); ++i) {
+    cells_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void PackedFramebuffer::Resolve(Framebuffer& target) const {
+  for (int i = 0; i < Size(); ++i) {
+    const uint32_t word = At(i);
+
+    target.Chars()[i] = word ? UnpackChar(word) : ' ';
+    target.Depths()[i] = UnpackDepth(word);
+  }
+}
+
+}  // namespace core
@@ -0,0 +1,202 @@
+#include "core/parallel_raster.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+
+#include "core/epoch_framebuffer.h"
+#include "core/framebuffer.h"
+#include "core/packed_framebuffer.h"
+#include "core/point_cloud.h"
+#include "core/shade_kernel.h"
+
+namespace core {
+
+RasterCounters& RasterCounters::operator+=(const RasterCounters& other) {
+  points += other.points;
+  off_screen += other.off_screen;
+  culled += other.culled;
+  drawn += other.drawn;
+  return *this;
+}
+
+ParallelRasterizer::ParallelRasterizer(int thread_count)
+    : pool_(thread_count), workers_(pool_.Size()) {
+  for (Worker& worker : workers_) {
+    worker.cells.resize(kBlockSize);
+    worker.depths.resize(kBlockSize);
+    worker.glyphs.resize(kBlockSize);
+  }
+}
+
+int ParallelRasterizer::ThreadCount() const {
+  return pool_.Size();
+}
+
+const RasterCounters& ParallelRasterizer::LastCounters() const {
+  return counters_;
+}
+
+template <typename T>
+void ParallelRasterizer::Rasterize(const PointCloudT<T>& points,
+                                   const ShadeParams& params,
+                                   std::string_view glyphs,
+                                   Framebuffer& target) {
+  RasterizeMerged(points, params, glyphs, target);
+}
+
+template <typename T>
+void ParallelRasterizer::Rasterize(const PointCloudT<T>& points,
+                                   const ShadeParams& params,
+                                   std::string_view glyphs,
+                                   EpochFramebuffer& target) {
+  RasterizeMerged(points, params, glyphs, target);
+}
+
+template <typename T, typename Target>
+void ParallelRasterizer::RasterizeMerged(const PointCloudT<T>& points,
+                                         const ShadeParams& params,
+                                         std::string_view glyphs,
+                                         Target& target) {
+  const int worker_count = workers_.size();
+
+  // nothing to merge with a single thread
+  if (worker_count == 1) {
+    RasterizeRange(points, 0, points.Size(), params, glyphs, workers_[0],
+                   target);
+    CollectCounters();
+    return;
+  }
+
+  for (Worker& worker : workers_) {
+    if (worker.frame.GetWidth() != target.GetWidth() ||
+        worker.frame.GetHeight() != target.GetHeight()) {
+      worker.frame.Resize(target.GetWidth(), target.GetHeight());
+    }
+  }
+
+  pool_.ParallelFor(worker_count, [&](int w) {
+    const std::size_t begin = points.Size() * w / worker_count;
+    const std::size_t end = points.Size() * (w + 1) / worker_count;
+    Worker& worker = workers_[w];
+
+    RasterizeRange(points, begin, end, params, glyphs, worker, worker.frame);
+  });
+
+  // bands of whole rows, EpochFramebuffer keeps its touched spans per row
+  const int width = target.GetWidth();
+  const int height = target.GetHeight();
+  pool_.ParallelFor(worker_count, [&](int band) {
+    MergeRange(height * band / worker_count * width,
+               height * (band + 1) / worker_count * width, target);
+  });
+
+  for (Worker& worker : workers_) {
+    worker.min_cell = 0;
+    worker.max_cell = -1;
+  }
+  CollectCounters();
+}
+
+template <typename T>
+void ParallelRasterizer::Rasterize(const PointCloudT<T>& points,
+                                   const ShadeParams& params,
+                                   std::string_view glyphs,
+                                   PackedFramebuffer& target) {
+  const int worker_count = workers_.size();
+
+  pool_.ParallelFor(worker_count, [&](int w) {
+    const std::size_t begin = points.Size() * w / worker_count;
+    const std::size_t end = points.Size() * (w + 1) / worker_count;
+
+    RasterizeRange(points, begin, end, params, glyphs, workers_[w], target);
+  });
+  CollectCounters();
+}
+
+template <typename T, typename Frame>
+void ParallelRasterizer::RasterizeRange(const PointCloudT<T>& points,
+                                        std::size_t begin,
+                                        std::size_t end,
+                                        const ShadeParams& params,
+                                        std::string_view glyphs,
+                                        Worker& worker,
+                                        Frame& frame) {
+  int min_cell = frame.Size();
+  int max_cell = -1;
+  RasterCounters counters{.points = (int64_t)(end - begin)};
+
+  for (std::size_t block = begin; block < end; block += kBlockSize) {
+    const std::size_t block_end = std::min(block + kBlockSize, end);
+    TransformAndShade(points, block, block_end, params,
+                      {worker.cells, worker.depths, worker.glyphs});
+
+    for (std::size_t i = 0; i < block_end - block; ++i) {
+      const int cell = worker.cells[i];
+      if (cell >= 0) {
+        frame.PutAt(cell, worker.depths[i], glyphs[worker.glyphs[i]]);
+        min_cell = std::min(min_cell, cell);
+        max_cell = std::max(max_cell, cell);
+        ++counters.drawn;
+      } else {
+        counters.culled += cell == kCellCulled;
+      }
+    }
+  }
+
+  counters.off_screen = counters.points - counters.drawn - counters.culled;
+  worker.min_cell = min_cell;
+  worker.max_cell = max_cell;
+  worker.counters = counters;
+}
+
+void ParallelRasterizer::CollectCounters() {
+  counters_ = RasterCounters{};
+  for (const Worker& worker : workers_) {
+    counters_ += worker.counters;
+  }
+}
+
+template <typename Target>
+void ParallelRasterizer::MergeRange(int begin, int end, Target& target) {
+  for (Worker& worker : workers_) {
+    const int from = std::max(begin, worker.min_cell);
+    const int to = std::min(end, worker.max_cell + 1);
+
+    for (int cell = from; cell < to; ++cell) {
+      double& depth = worker.frame.Depths()[cell];
+      char& sym = worker.frame.Chars()[cell];
+
+      target.PutAt(cell, depth, sym);
+      depth = 0.0;
+      sym = ' ';
+    }
+  }
+}
+
+template void ParallelRasterizer::Rasterize(const PointCloudT<float>&,
+                                            const ShadeParams&,
+                                            std::string_view,
+                                            Framebuffer&);
+template void ParallelRasterizer::Rasterize(const PointCloudT<double>&,
+                                            const ShadeParams&,
+                                            std::string_view,
+                                            Framebuffer&);
+template void ParallelRasterizer::Rasterize(const PointCloudT<float>&,
+                                            const ShadeParams&,
+                                            std::string_view,
+                                            EpochFramebuffer&);
+template void ParallelRasterizer::Rasterize(const PointCloudT<double>&,
+                                            const ShadeParams&,
+                                            std::string_view,
+                                            EpochFramebuffer&);
+template void ParallelRasterizer::Rasterize(const PointCloudT<float>&,
+                                            const ShadeParams&,
+                                            std::string_view,
+                                            PackedFramebuffer&);
+template void ParallelRasterizer::Rasterize(const PointCloudT<double>&,
+                                            const ShadeParams&,
+                                            std::string_view,
+                                            PackedFramebuffer&);
+
+}  // namespace core
@@ -0,0 +1,49 @@
+#include "core/point_cloud.h"
+
+#include <cstddef>
+#include <memory_resource>
+
+#include "core/point_info.h"
+
+namespace core {
+
+template <typename T>
+PointCloudT<T>::PointCloudT(std::pmr::memory_resource* resource)
+    : x_(resource),
+      y_(resource),
+      z_(resource),
+      nx_(resource),
+      ny_(resource),
+      nz_(resource) {}
+
+template <typename T>
+PointCloudT<T>::PointCloudT(std::size_t size,
+                            std::pmr::memory_resource* resource)
+    : PointCloudT(resource) {
+  Resize(size);
+}
+
+template <typename T>
+void PointCloudT<T>::Resize(std::size_t size) {
+  x_.resize(size);
+  y_.resize(size);
+  z_.resize(size);
+  nx_.resize(size);
+  ny_.resize(size);
+  nz_.resize(size);
+}
+
+template <typename T>
+void PointCloudT<T>::Set(std::size_t index, const PointInfoT<T>& point_info) {
+  x_[index] = point_info.p.x;
+  y_[index] = point_info.p.y;
+  z_[index] = point_info.p.z;
+  nx_[index] = point_info.normal.x;
+  ny_[index] = point_info.normal.y;
+  nz_[index] = point_info.normal.z;
+}
+
+template class PointCloudT<float>;
+template class PointCloudT<double>;
+
+}  // namespace core
@@ -0,0 +1,132 @@
+#include "core/presenter.h"
+
+#include <charconv>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+namespace core {
+
+namespace {
+
+// "\033[H" moves the cursor to the top left corner
+constexpr std::string_view kCursorHome = "\033[H";
+
+int DigitCount(int number) {
+  int digits = 1;
+  for (; number >= 10; number /= 10) {
+    ++digits;
+  }
+  return digits;
+}
+
+// size of "\033[<count>C"
+int ForwardSize(int count) {
+  return 3 + DigitCount(count);
+}
+
+}  // namespace
+
+Presenter::Presenter(int width, int height) {
+  Resize(width, height);
+}
+
+void Presenter::Resize(int width, int height) {
+  width_ = width;
+  height_ = height;
+  presented_ = false;
+  previous_.assign(width * height, ' ');
+  out_.reserve(kCursorHome.size() + width * height);
+}
+
+void Presenter::Invalidate() {
+  presented_ = false;
+}
+
+std::string_view Presenter::Present(std::span<const char> frame) {
+  out_.clear();
+
+  const bool full = !presented_ || !AppendDiff(frame);
+  if (full) {
+    out_.clear();
+    AppendFull(frame);
+    ++stats_.full_redraws;
+  }
+
+  std::memcpy(previous_.data(), frame.data(), previous_.size());
+  presented_ = true;
+  ++stats_.frames;
+  stats_.last_frame_bytes = out_.size();
+  stats_.total_bytes += out_.size();
+  return out_;
+}
+
+bool Presenter::AppendDiff(std::span<const char> frame) {
+  const std::size_t full_size = kCursorHome.size() + frame.size();
+
+  for (int row = 0; row < height_; ++row) {
+    const char* now = frame.data() + row * width_;
+    const char* before = previous_.data() + row * width_;
+    if (std::memcmp(now, before, width_) == 0) {
+      continue;
+    }
+
+    // column the cursor is at, -1 before the first span of the row
+    int cursor = -1;
+    int col = 0;
+    while (col < width_) {
+      if (now[col] == before[col]) {
+        ++col;
+        continue;
+      }
+      int end = col + 1;
+      while (end < width_ && now[end] != before[end]) {
+        ++end;
+      }
+
+      if (cursor < 0) {
+        AppendMove(row, col);
+      } else if (col - cursor <= ForwardSize(col - cursor)) {
+        out_.append(now + cursor, col - cursor);
+      } else {
+        AppendForward(col - cursor);
+      }
+      out_.append(now + col, end - col);
+      cursor = end;
+      col = end;
+
+      if (out_.size() > full_size) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void Presenter::AppendFull(std::span<const char> frame) {
+  // rows follow each other through the terminal's line wrapping
+  out_.append(kCursorHome);
+  out_.append(frame.data(), frame.size());
+}
+
+void Presenter::AppendMove(int row, int col) {
+  out_.append("\033[");
+  AppendNumber(row + 1);
+  out_.push_back(';');
+  AppendNumber(col + 1);
+  out_.push_back('H');
+}
+
+void Presenter::AppendForward(int count) {
+  out_.append("\033[");
+  AppendNumber(count);
+  out_.push_back('C');
+}
+
+void Presenter::AppendNumber(int number) {
+  char digits[16];
+  char* end = std::to_chars(digits, digits + sizeof(digits), number).ptr;
+  out_.append(digits, end - digits);
+}
+
+}  // namespace core
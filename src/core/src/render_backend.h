@@ -0,0 +1,33 @@
+#ifndef DONUTCPP_CORE_RENDER_BACKEND_H_
+#define DONUTCPP_CORE_RENDER_BACKEND_H_
+
+#include <span>
+
+#include "core/presenter.h"
+#include "core/result.h"
+
+namespace core {
+
+/**
+ * Where VulkanRenderer frames go once they are drawn. The render loop polls
+ * it from the render thread, Present may be called from the presenter
+ * thread in kPresentThread mode.
+ */
+class RenderBackend {
+ public:
+  virtual ~RenderBackend() = default;
+
+  // true once the output is gone, e.g. the window was closed
+  virtual bool ShouldClose() = 0;
+  virtual void PollEvents() = 0;
+  // hands over a finished frame of width * height chars
+  virtual Result Present(std::span<const char> frame) = 0;
+
+  // the last frame passed to Present
+  virtual std::span<const char> PresentedFrame() const = 0;
+  virtual const PresentStats& Stats() const = 0;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_RENDER_BACKEND_H_
@@ -19,6 +19,14 @@ const std::string CoreErrorToString(CoreError e) {
       return "Physical Device doesn't have any available surface formats";
     case kNoAvailableSurfacePresentModes:
       return "Physical Device doesn't have any available surface present modes";
+    case kTerminalWriteFailed:
+      return "Could not write to the terminal";
+    case kFrameSinkWriteFailed:
+      return "Could not write a frame to its sink";
+    case kRecordingFailed:
+      return "Could not write the recording";
+    case kInvalidRecording:
+      return "Not a valid frame recording";
     default:
       return "Unknown error code";
   }
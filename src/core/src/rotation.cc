@@ -1,24 +1,129 @@
 #include "core/rotation.h"
 
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+#include "core/mat3.h"
 #include "core/quaternion.h"
 #include "core/vec3.h"
 
 namespace core {
 
-Vec3 Rotate(const Vec3& point,
-            const Vec3& axis,
-            double angle,
-            const Vec3& center) {
-  const Vec3 norm_axis = axis.Normalized();
+template <typename T>
+Vec3T<T> Rotate(const Vec3T<T>& point,
+                const Vec3T<T>& axis,
+                std::type_identity_t<T> angle,
+                const Vec3T<T>& center) {
+  const Vec3T<T> norm_axis = axis.Normalized();
   if (!norm_axis.IsValid()) {
     return point;
   }
-  const Quat q = Quat::FromAxisAndAngle(norm_axis, angle);
-  const Quat q_conj = q.Conjugate();
-  const Quat h = Quat::Pure(point - center);
+  const QuatT<T> q = QuatT<T>::FromAxisAndAngle(norm_axis, angle);
+  const QuatT<T> q_conj = q.Conjugate();
+  const QuatT<T> h = QuatT<T>::Pure(point - center);
 
-  const Quat rotated_q = q * h * q_conj;
+  const QuatT<T> rotated_q = q * h * q_conj;
   return rotated_q.ExtractVector() + center;
 }
 
+template <typename T>
+RotationT<T>::RotationT(const Vec3T<T>& axis, T angle, const Vec3T<T>& center) {
+  const Vec3T<T> norm_axis = axis.Normalized();
+  if (!norm_axis.IsValid()) {
+    return;
+  }
+  const QuatT<T> q = QuatT<T>::FromAxisAndAngle(norm_axis, angle);
+
+  // matrix form of q * p * q_conj for a unit quaternion q
+  matrix_ = Mat3T<T>{{
+      {
+          1 - 2 * (q.y * q.y + q.z * q.z),
+          2 * (q.x * q.y - q.s * q.z),
+          2 * (q.x * q.z + q.s * q.y),
+      },
+      {
+          2 * (q.x * q.y + q.s * q.z),
+          1 - 2 * (q.x * q.x + q.z * q.z),
+          2 * (q.y * q.z - q.s * q.x),
+      },
+      {
+          2 * (q.x * q.z - q.s * q.y),
+          2 * (q.y * q.z + q.s * q.x),
+          1 - 2 * (q.x * q.x + q.y * q.y),
+      },
+  }};
+  // R(p - c) + c = Rp + (c - Rc)
+  offset_ = center - matrix_ * center;
+}
+
+template <typename T>
+RotationT<T> RotationT<T>::Then(const RotationT& next) const {
+  RotationT result;
+  result.matrix_ = next.matrix_ * matrix_;
+  result.offset_ = next.matrix_ * offset_ + next.offset_;
+  return result;
+}
+
+template <typename T>
+Vec3T<T> RotationT<T>::Apply(const Vec3T<T>& point) const {
+  return matrix_ * point + offset_;
+}
+
+template <typename T>
+Vec3T<T> RotationT<T>::ApplyToDirection(const Vec3T<T>& direction) const {
+  return matrix_ * direction;
+}
+
+template <typename T>
+void RotationT<T>::Apply(std::span<const Vec3T<T>> in,
+                         std::span<Vec3T<T>> out) const {
+  assert(out.size() >= in.size());
+
+  for (size_t i = 0; i < in.size(); ++i) {
+    out[i] = Apply(in[i]);
+  }
+}
+
+template <typename T>
+void RotationT<T>::ApplyToDirection(std::span<const Vec3T<T>> in,
+                                    std::span<Vec3T<T>> out) const {
+  assert(out.size() >= in.size());
+
+  for (size_t i = 0; i < in.size(); ++i) {
+    out[i] = ApplyToDirection(in[i]);
+  }
+}
+
+template <typename T>
+void RotateMany(std::span<const Vec3T<std::type_identity_t<T>>> in,
+                std::span<Vec3T<std::type_identity_t<T>>> out,
+                const Vec3T<T>& axis,
+                std::type_identity_t<T> angle,
+                const Vec3T<T>& center) {
+  RotationT<T>(axis, angle, center).Apply(in, out);
+}
+
+template Vec3T<float> Rotate(const Vec3T<float>&,
+                             const Vec3T<float>&,
+                             float,
+                             const Vec3T<float>&);
+template Vec3T<double> Rotate(const Vec3T<double>&,
+                              const Vec3T<double>&,
+                              double,
+                              const Vec3T<double>&);
+template class RotationT<float>;
+template class RotationT<double>;
+template void RotateMany(std::span<const Vec3T<float>>,
+                         std::span<Vec3T<float>>,
+                         const Vec3T<float>&,
+                         float,
+                         const Vec3T<float>&);
+template void RotateMany(std::span<const Vec3T<double>>,
+                         std::span<Vec3T<double>>,
+                         const Vec3T<double>&,
+                         double,
+                         const Vec3T<double>&);
+
 }  // namespace core
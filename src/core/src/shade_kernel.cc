@@ -0,0 +1,793 @@
+#include "core/shade_kernel.h"
+
+#if defined(__x86_64__)
+#define DONUTCPP_CORE_SHADE_KERNEL_X86
+#include <immintrin.h>
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "core/mat3.h"
+#include "core/point_cloud.h"
+#include "core/vec3.h"
+
+/*
+ * Every level evaluates the same expressions in the same order and the file
+ * is built with -ffp-contract=off, so all levels give bit-identical results.
+ * Truncation towards zero mirrors the (int) casts of the scalar render loop.
+ */
+
+namespace core {
+
+namespace {
+
+// light in the space of the normals it is dotted with
+Vec3 ShadingLight(const ShadeParams& params) {
+  switch (params.lighting) {
+    case kLightingObjectSpace:
+      // the inverse of a rotation is its transpose
+      return params.matrix.Transposed() * params.light;
+    case kLightingWorldSpace:
+    default:
+      return params.light;
+  }
+}
+
+// ShadeParams converted once to the precision of the processed points
+template <typename T>
+struct KernelParams {
+  Mat3T<T> matrix;
+  Vec3T<T> offset;
+  T aspect_ratio;
+  Vec3T<T> light;
+  T levels;
+  T width;
+  T height;
+  // normals are dotted with `light` as stored, without the matrix
+  bool object_space;
+  bool cull_back_faces;
+
+  explicit KernelParams(const ShadeParams& params)
+      : matrix(params.matrix.As<T>()),
+        offset(params.offset.As<T>()),
+        aspect_ratio((T)params.aspect_ratio),
+        light(ShadingLight(params).As<T>()),
+        levels((T)params.light_level_count),
+        width((T)params.width),
+        height((T)params.height),
+        object_space(params.lighting == kLightingObjectSpace),
+        cull_back_faces(params.cull_back_faces) {}
+};
+
+// output for the points that start `offset` points into the processed range
+ShadeOutput Advance(const ShadeOutput& out, std::size_t offset) {
+  return ShadeOutput{
+      .cell = out.cell.subspan(offset),
+      .depth = out.depth.subspan(offset),
+      .glyph = out.glyph.subspan(offset),
+  };
+}
+
+template <typename T>
+void ShadeScalar(const PointCloudT<T>& points,
+                 std::size_t begin,
+                 std::size_t end,
+                 const KernelParams<T>& params,
+                 const ShadeOutput& out) {
+  const auto& m = params.matrix.m;
+  const T width = params.width;
+  const T height = params.height;
+  const T levels = params.levels;
+
+  for (std::size_t i = begin; i < end; ++i) {
+    const T x = points.X()[i];
+    const T y = points.Y()[i];
+    const T z = points.Z()[i];
+    const T nx = points.Nx()[i];
+    const T ny = points.Ny()[i];
+    const T nz = points.Nz()[i];
+
+    const T sx = (m[0][0] * x + m[0][1] * y + m[0][2] * z + params.offset.x) /
+                 params.aspect_ratio;
+    const T sy = m[1][0] * x + m[1][1] * y + m[1][2] * z + params.offset.y;
+    const T sz = m[2][0] * x + m[2][1] * y + m[2][2] * z + params.offset.z;
+
+    const T xt = std::trunc(sx * width);
+    const T yt = std::trunc(sy * height);
+    const bool on_screen =
+        xt >= 0 && xt <= width - 1 && yt >= 0 && yt <= height - 1;
+    out.depth[i - begin] = sz;
+
+    const bool world = !params.object_space;
+    const T rnx = world ? m[0][0] * nx + m[0][1] * ny + m[0][2] * nz : nx;
+    const T rny = world ? m[1][0] * nx + m[1][1] * ny + m[1][2] * nz : ny;
+    const T rnz = world ? m[2][0] * nx + m[2][1] * ny + m[2][2] * nz : nz;
+    int32_t cell = on_screen ? (int32_t)(yt * width + xt) : kCellOffScreen;
+    if (params.cull_back_faces) {
+      const T view_nz =
+          world ? rnz : m[2][0] * nx + m[2][1] * ny + m[2][2] * nz;
+      cell = on_screen && view_nz < 0 ? kCellCulled : cell;
+    }
+    out.cell[i - begin] = cell;
+    T dot = params.light.x * rnx + params.light.y * rny + params.light.z * rnz;
+    dot = dot > 0 ? dot : 0;
+    dot = dot < 1 ? dot : 1;
+    T light_index = std::trunc(dot * levels);
+    light_index = light_index < levels - 1 ? light_index : levels - 1;
+    out.glyph[i - begin] = (uint8_t)light_index;
+  }
+}
+
+#ifdef DONUTCPP_CORE_SHADE_KERNEL_X86
+
+inline __m128d DotSse2(const double (&row)[3],
+                       __m128d a,
+                       __m128d b,
+                       __m128d c) {
+  return _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_set1_pd(row[0]), a),
+                               _mm_mul_pd(_mm_set1_pd(row[1]), b)),
+                    _mm_mul_pd(_mm_set1_pd(row[2]), c));
+}
+
+inline __m128d TruncSse2(__m128d v) {
+  return _mm_cvtepi32_pd(_mm_cvttpd_epi32(v));
+}
+
+// processes 2 points starting at `i`, writes output starting at `o`
+inline void ShadeSse2Step(const PointCloudT<double>& points,
+                          std::size_t i,
+                          std::size_t o,
+                          const KernelParams<double>& params,
+                          const ShadeOutput& out) {
+  const auto& m = params.matrix.m;
+  const __m128d x = _mm_loadu_pd(&points.X()[i]);
+  const __m128d y = _mm_loadu_pd(&points.Y()[i]);
+  const __m128d z = _mm_loadu_pd(&points.Z()[i]);
+  const __m128d nx = _mm_loadu_pd(&points.Nx()[i]);
+  const __m128d ny = _mm_loadu_pd(&points.Ny()[i]);
+  const __m128d nz = _mm_loadu_pd(&points.Nz()[i]);
+
+  const __m128d width = _mm_set1_pd(params.width);
+  const __m128d height = _mm_set1_pd(params.height);
+  const __m128d zero = _mm_setzero_pd();
+  const __m128d one = _mm_set1_pd(1.0);
+
+  const __m128d sx = _mm_div_pd(
+      _mm_add_pd(DotSse2(m[0], x, y, z), _mm_set1_pd(params.offset.x)),
+      _mm_set1_pd(params.aspect_ratio));
+  const __m128d sy =
+      _mm_add_pd(DotSse2(m[1], x, y, z), _mm_set1_pd(params.offset.y));
+  const __m128d sz =
+      _mm_add_pd(DotSse2(m[2], x, y, z), _mm_set1_pd(params.offset.z));
+
+  const __m128d xt = TruncSse2(_mm_mul_pd(sx, width));
+  const __m128d yt = TruncSse2(_mm_mul_pd(sy, height));
+  const __m128d on_screen = _mm_and_pd(
+      _mm_and_pd(_mm_cmpge_pd(xt, zero),
+                 _mm_cmple_pd(xt, _mm_sub_pd(width, one))),
+      _mm_and_pd(_mm_cmpge_pd(yt, zero),
+                 _mm_cmple_pd(yt, _mm_sub_pd(height, one))));
+  __m128d cell =
+      _mm_or_pd(_mm_and_pd(on_screen, _mm_add_pd(_mm_mul_pd(yt, width), xt)),
+                _mm_andnot_pd(on_screen, _mm_set1_pd(kCellOffScreen)));
+  _mm_storeu_pd(&out.depth[o], sz);
+
+  const bool world = !params.object_space;
+  const __m128d rnx = world ? DotSse2(m[0], nx, ny, nz) : nx;
+  const __m128d rny = world ? DotSse2(m[1], nx, ny, nz) : ny;
+  const __m128d rnz = world ? DotSse2(m[2], nx, ny, nz) : nz;
+  if (params.cull_back_faces) {
+    const __m128d view_nz = world ? rnz : DotSse2(m[2], nx, ny, nz);
+    const __m128d back = _mm_and_pd(on_screen, _mm_cmplt_pd(view_nz, zero));
+    cell = _mm_or_pd(_mm_andnot_pd(back, cell),
+                     _mm_and_pd(back, _mm_set1_pd(kCellCulled)));
+  }
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(&out.cell[o]),
+                   _mm_cvttpd_epi32(cell));
+  __m128d dot = _mm_add_pd(
+      _mm_add_pd(_mm_mul_pd(_mm_set1_pd(params.light.x), rnx),
+                 _mm_mul_pd(_mm_set1_pd(params.light.y), rny)),
+      _mm_mul_pd(_mm_set1_pd(params.light.z), rnz));
+  dot = _mm_min_pd(_mm_max_pd(dot, zero), one);
+  const __m128d levels = _mm_set1_pd(params.levels);
+  const __m128d light_index =
+      _mm_min_pd(TruncSse2(_mm_mul_pd(dot, levels)), _mm_sub_pd(levels, one));
+
+  int32_t glyphs[4];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(glyphs),
+                   _mm_cvttpd_epi32(light_index));
+  out.glyph[o] = (uint8_t)glyphs[0];
+  out.glyph[o + 1] = (uint8_t)glyphs[1];
+}
+
+std::size_t ShadeSse2(const PointCloudT<double>& points,
+                      std::size_t begin,
+                      std::size_t end,
+                      const KernelParams<double>& params,
+                      const ShadeOutput& out) {
+  std::size_t i = begin;
+  for (; i + 4 <= end; i += 4) {
+    ShadeSse2Step(points, i, i - begin, params, out);
+    ShadeSse2Step(points, i + 2, i + 2 - begin, params, out);
+  }
+  return i;
+}
+
+inline __m128 DotSse2(const float (&row)[3], __m128 a, __m128 b, __m128 c) {
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(row[0]), a),
+                               _mm_mul_ps(_mm_set1_ps(row[1]), b)),
+                    _mm_mul_ps(_mm_set1_ps(row[2]), c));
+}
+
+inline __m128 TruncSse2(__m128 v) {
+  return _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+}
+
+// processes 4 points starting at `i`, writes output starting at `o`
+inline void ShadeSse2Step(const PointCloudT<float>& points,
+                          std::size_t i,
+                          std::size_t o,
+                          const KernelParams<float>& params,
+                          const ShadeOutput& out) {
+  const auto& m = params.matrix.m;
+  const __m128 x = _mm_loadu_ps(&points.X()[i]);
+  const __m128 y = _mm_loadu_ps(&points.Y()[i]);
+  const __m128 z = _mm_loadu_ps(&points.Z()[i]);
+  const __m128 nx = _mm_loadu_ps(&points.Nx()[i]);
+  const __m128 ny = _mm_loadu_ps(&points.Ny()[i]);
+  const __m128 nz = _mm_loadu_ps(&points.Nz()[i]);
+
+  const __m128 width = _mm_set1_ps(params.width);
+  const __m128 height = _mm_set1_ps(params.height);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+
+  const __m128 sx = _mm_div_ps(
+      _mm_add_ps(DotSse2(m[0], x, y, z), _mm_set1_ps(params.offset.x)),
+      _mm_set1_ps(params.aspect_ratio));
+  const __m128 sy =
+      _mm_add_ps(DotSse2(m[1], x, y, z), _mm_set1_ps(params.offset.y));
+  const __m128 sz =
+      _mm_add_ps(DotSse2(m[2], x, y, z), _mm_set1_ps(params.offset.z));
+
+  const __m128 xt = TruncSse2(_mm_mul_ps(sx, width));
+  const __m128 yt = TruncSse2(_mm_mul_ps(sy, height));
+  const __m128 on_screen = _mm_and_ps(
+      _mm_and_ps(_mm_cmpge_ps(xt, zero),
+                 _mm_cmple_ps(xt, _mm_sub_ps(width, one))),
+      _mm_and_ps(_mm_cmpge_ps(yt, zero),
+                 _mm_cmple_ps(yt, _mm_sub_ps(height, one))));
+  __m128 cell =
+      _mm_or_ps(_mm_and_ps(on_screen, _mm_add_ps(_mm_mul_ps(yt, width), xt)),
+                _mm_andnot_ps(on_screen, _mm_set1_ps(kCellOffScreen)));
+  _mm_storeu_pd(&out.depth[o], _mm_cvtps_pd(sz));
+  _mm_storeu_pd(&out.depth[o + 2], _mm_cvtps_pd(_mm_movehl_ps(sz, sz)));
+
+  const bool world = !params.object_space;
+  const __m128 rnx = world ? DotSse2(m[0], nx, ny, nz) : nx;
+  const __m128 rny = world ? DotSse2(m[1], nx, ny, nz) : ny;
+  const __m128 rnz = world ? DotSse2(m[2], nx, ny, nz) : nz;
+  if (params.cull_back_faces) {
+    const __m128 view_nz = world ? rnz : DotSse2(m[2], nx, ny, nz);
+    const __m128 back = _mm_and_ps(on_screen, _mm_cmplt_ps(view_nz, zero));
+    cell = _mm_or_ps(_mm_andnot_ps(back, cell),
+                     _mm_and_ps(back, _mm_set1_ps(kCellCulled)));
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&out.cell[o]),
+                   _mm_cvttps_epi32(cell));
+  __m128 dot = _mm_add_ps(
+      _mm_add_ps(_mm_mul_ps(_mm_set1_ps(params.light.x), rnx),
+                 _mm_mul_ps(_mm_set1_ps(params.light.y), rny)),
+      _mm_mul_ps(_mm_set1_ps(params.light.z), rnz));
+  dot = _mm_min_ps(_mm_max_ps(dot, zero), one);
+  const __m128 levels = _mm_set1_ps(params.levels);
+  const __m128 light_index =
+      _mm_min_ps(TruncSse2(_mm_mul_ps(dot, levels)), _mm_sub_ps(levels, one));
+
+  const __m128i light_index_i32 = _mm_cvttps_epi32(light_index);
+  const __m128i light_index_i16 =
+      _mm_packs_epi32(light_index_i32, light_index_i32);
+  const int32_t glyphs =
+      _mm_cvtsi128_si32(_mm_packus_epi16(light_index_i16, light_index_i16));
+  std::memcpy(&out.glyph[o], &glyphs, 4);
+}
+
+std::size_t ShadeSse2(const PointCloudT<float>& points,
+                      std::size_t begin,
+                      std::size_t end,
+                      const KernelParams<float>& params,
+                      const ShadeOutput& out) {
+  std::size_t i = begin;
+  for (; i + 8 <= end; i += 8) {
+    ShadeSse2Step(points, i, i - begin, params, out);
+    ShadeSse2Step(points, i + 4, i + 4 - begin, params, out);
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) inline __m256d DotAvx2(const double (&row)[3],
+                                                       __m256d a,
+                                                       __m256d b,
+                                                       __m256d c) {
+  return _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(row[0]), a),
+                                     _mm256_mul_pd(_mm256_set1_pd(row[1]), b)),
+                       _mm256_mul_pd(_mm256_set1_pd(row[2]), c));
+}
+
+__attribute__((target("avx2"))) inline __m256d TruncAvx2(__m256d v) {
+  return _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(v));
+}
+
+// processes 4 points starting at `i`, writes output starting at `o`
+__attribute__((target("avx2"))) inline void ShadeAvx2Step(
+    const PointCloudT<double>& points,
+    std::size_t i,
+    std::size_t o,
+    const KernelParams<double>& params,
+    const ShadeOutput& out) {
+  const auto& m = params.matrix.m;
+  const __m256d x = _mm256_loadu_pd(&points.X()[i]);
+  const __m256d y = _mm256_loadu_pd(&points.Y()[i]);
+  const __m256d z = _mm256_loadu_pd(&points.Z()[i]);
+  const __m256d nx = _mm256_loadu_pd(&points.Nx()[i]);
+  const __m256d ny = _mm256_loadu_pd(&points.Ny()[i]);
+  const __m256d nz = _mm256_loadu_pd(&points.Nz()[i]);
+
+  const __m256d width = _mm256_set1_pd(params.width);
+  const __m256d height = _mm256_set1_pd(params.height);
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d one = _mm256_set1_pd(1.0);
+
+  const __m256d sx = _mm256_div_pd(
+      _mm256_add_pd(DotAvx2(m[0], x, y, z), _mm256_set1_pd(params.offset.x)),
+      _mm256_set1_pd(params.aspect_ratio));
+  const __m256d sy =
+      _mm256_add_pd(DotAvx2(m[1], x, y, z), _mm256_set1_pd(params.offset.y));
+  const __m256d sz =
+      _mm256_add_pd(DotAvx2(m[2], x, y, z), _mm256_set1_pd(params.offset.z));
+
+  const __m256d xt = TruncAvx2(_mm256_mul_pd(sx, width));
+  const __m256d yt = TruncAvx2(_mm256_mul_pd(sy, height));
+  const __m256d on_screen = _mm256_and_pd(
+      _mm256_and_pd(_mm256_cmp_pd(xt, zero, _CMP_GE_OQ),
+                    _mm256_cmp_pd(xt, _mm256_sub_pd(width, one), _CMP_LE_OQ)),
+      _mm256_and_pd(
+          _mm256_cmp_pd(yt, zero, _CMP_GE_OQ),
+          _mm256_cmp_pd(yt, _mm256_sub_pd(height, one), _CMP_LE_OQ)));
+  __m256d cell =
+      _mm256_blendv_pd(_mm256_set1_pd(kCellOffScreen),
+                       _mm256_add_pd(_mm256_mul_pd(yt, width), xt), on_screen);
+  _mm256_storeu_pd(&out.depth[o], sz);
+
+  const bool world = !params.object_space;
+  const __m256d rnx = world ? DotAvx2(m[0], nx, ny, nz) : nx;
+  const __m256d rny = world ? DotAvx2(m[1], nx, ny, nz) : ny;
+  const __m256d rnz = world ? DotAvx2(m[2], nx, ny, nz) : nz;
+  if (params.cull_back_faces) {
+    const __m256d view_nz = world ? rnz : DotAvx2(m[2], nx, ny, nz);
+    const __m256d back =
+        _mm256_and_pd(on_screen, _mm256_cmp_pd(view_nz, zero, _CMP_LT_OQ));
+    cell = _mm256_blendv_pd(cell, _mm256_set1_pd(kCellCulled), back);
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&out.cell[o]),
+                   _mm256_cvttpd_epi32(cell));
+  __m256d dot = _mm256_add_pd(
+      _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(params.light.x), rnx),
+                    _mm256_mul_pd(_mm256_set1_pd(params.light.y), rny)),
+      _mm256_mul_pd(_mm256_set1_pd(params.light.z), rnz));
+  dot = _mm256_min_pd(_mm256_max_pd(dot, zero), one);
+  const __m256d levels = _mm256_set1_pd(params.levels);
+  const __m256d light_index = _mm256_min_pd(
+      TruncAvx2(_mm256_mul_pd(dot, levels)), _mm256_sub_pd(levels, one));
+
+  const __m128i light_index_i32 = _mm256_cvttpd_epi32(light_index);
+  const __m128i light_index_i16 =
+      _mm_packs_epi32(light_index_i32, light_index_i32);
+  const int32_t glyphs =
+      _mm_cvtsi128_si32(_mm_packus_epi16(light_index_i16, light_index_i16));
+  std::memcpy(&out.glyph[o], &glyphs, 4);
+}
+
+__attribute__((target("avx2"))) std::size_t ShadeAvx2(
+    const PointCloudT<double>& points,
+    std::size_t begin,
+    std::size_t end,
+    const KernelParams<double>& params,
+    const ShadeOutput& out) {
+  std::size_t i = begin;
+  for (; i + 8 <= end; i += 8) {
+    ShadeAvx2Step(points, i, i - begin, params, out);
+    ShadeAvx2Step(points, i + 4, i + 4 - begin, params, out);
+  }
+  return i;
+}
+
+__attribute__((target("avx2"))) inline __m256 DotAvx2(const float (&row)[3],
+                                                      __m256 a,
+                                                      __m256 b,
+                                                      __m256 c) {
+  return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(row[0]), a),
+                                     _mm256_mul_ps(_mm256_set1_ps(row[1]), b)),
+                       _mm256_mul_ps(_mm256_set1_ps(row[2]), c));
+}
+
+__attribute__((target("avx2"))) inline __m256 TruncAvx2(__m256 v) {
+  return _mm256_cvtepi32_ps(_mm256_cvttps_epi32(v));
+}
+
+// processes 8 points starting at `i`, writes output starting at `o`
+__attribute__((target("avx2"))) inline void ShadeAvx2Step(
+    const PointCloudT<float>& points,
+    std::size_t i,
+    std::size_t o,
+    const KernelParams<float>& params,
+    const ShadeOutput& out) {
+  const auto& m = params.matrix.m;
+  const __m256 x = _mm256_loadu_ps(&points.X()[i]);
+  const __m256 y = _mm256_loadu_ps(&points.Y()[i]);
+  const __m256 z = _mm256_loadu_ps(&points.Z()[i]);
+  const __m256 nx = _mm256_loadu_ps(&points.Nx()[i]);
+  const __m256 ny = _mm256_loadu_ps(&points.Ny()[i]);
+  const __m256 nz = _mm256_loadu_ps(&points.Nz()[i]);
+
+  const __m256 width = _mm256_set1_ps(params.width);
+  const __m256 height = _mm256_set1_ps(params.height);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+
+  const __m256 sx = _mm256_div_ps(
+      _mm256_add_ps(DotAvx2(m[0], x, y, z), _mm256_set1_ps(params.offset.x)),
+      _mm256_set1_ps(params.aspect_ratio));
+  const __m256 sy =
+      _mm256_add_ps(DotAvx2(m[1], x, y, z), _mm256_set1_ps(params.offset.y));
+  const __m256 sz =
+      _mm256_add_ps(DotAvx2(m[2], x, y, z), _mm256_set1_ps(params.offset.z));
+
+  const __m256 xt = TruncAvx2(_mm256_mul_ps(sx, width));
+  const __m256 yt = TruncAvx2(_mm256_mul_ps(sy, height));
+  const __m256 on_screen = _mm256_and_ps(
+      _mm256_and_ps(_mm256_cmp_ps(xt, zero, _CMP_GE_OQ),
+                    _mm256_cmp_ps(xt, _mm256_sub_ps(width, one), _CMP_LE_OQ)),
+      _mm256_and_ps(
+          _mm256_cmp_ps(yt, zero, _CMP_GE_OQ),
+          _mm256_cmp_ps(yt, _mm256_sub_ps(height, one), _CMP_LE_OQ)));
+  __m256 cell =
+      _mm256_blendv_ps(_mm256_set1_ps(kCellOffScreen),
+                       _mm256_add_ps(_mm256_mul_ps(yt, width), xt), on_screen);
+  _mm256_storeu_pd(&out.depth[o], _mm256_cvtps_pd(_mm256_castps256_ps128(sz)));
+  _mm256_storeu_pd(&out.depth[o + 4],
+                   _mm256_cvtps_pd(_mm256_extractf128_ps(sz, 1)));
+
+  const bool world = !params.object_space;
+  const __m256 rnx = world ? DotAvx2(m[0], nx, ny, nz) : nx;
+  const __m256 rny = world ? DotAvx2(m[1], nx, ny, nz) : ny;
+  const __m256 rnz = world ? DotAvx2(m[2], nx, ny, nz) : nz;
+  if (params.cull_back_faces) {
+    const __m256 view_nz = world ? rnz : DotAvx2(m[2], nx, ny, nz);
+    const __m256 back =
+        _mm256_and_ps(on_screen, _mm256_cmp_ps(view_nz, zero, _CMP_LT_OQ));
+    cell = _mm256_blendv_ps(cell, _mm256_set1_ps(kCellCulled), back);
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out.cell[o]),
+                      _mm256_cvttps_epi32(cell));
+  __m256 dot = _mm256_add_ps(
+      _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(params.light.x), rnx),
+                    _mm256_mul_ps(_mm256_set1_ps(params.light.y), rny)),
+      _mm256_mul_ps(_mm256_set1_ps(params.light.z), rnz));
+  dot = _mm256_min_ps(_mm256_max_ps(dot, zero), one);
+  const __m256 levels = _mm256_set1_ps(params.levels);
+  const __m256 light_index = _mm256_min_ps(
+      TruncAvx2(_mm256_mul_ps(dot, levels)), _mm256_sub_ps(levels, one));
+
+  const __m256i light_index_i32 = _mm256_cvttps_epi32(light_index);
+  const __m128i light_index_i16 =
+      _mm_packs_epi32(_mm256_castsi256_si128(light_index_i32),
+                      _mm256_extracti128_si256(light_index_i32, 1));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(&out.glyph[o]),
+                   _mm_packus_epi16(light_index_i16, light_index_i16));
+}
+
+__attribute__((target("avx2"))) std::size_t ShadeAvx2(
+    const PointCloudT<float>& points,
+    std::size_t begin,
+    std::size_t end,
+    const KernelParams<float>& params,
+    const ShadeOutput& out) {
+  std::size_t i = begin;
+  for (; i + 16 <= end; i += 16) {
+    ShadeAvx2Step(points, i, i - begin, params, out);
+    ShadeAvx2Step(points, i + 8, i + 8 - begin, params, out);
+  }
+  return i;
+}
+
+// gcc 12 avx512 intrinsics trip -Wuninitialized on their own placeholders
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f"))) inline __m512d DotAvx512(
+    const double (&row)[3],
+    __m512d a,
+    __m512d b,
+    __m512d c) {
+  return _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(_mm512_set1_pd(row[0]), a),
+                                     _mm512_mul_pd(_mm512_set1_pd(row[1]), b)),
+                       _mm512_mul_pd(_mm512_set1_pd(row[2]), c));
+}
+
+__attribute__((target("avx512f"))) inline __m512d TruncAvx512(__m512d v) {
+  return _mm512_cvtepi32_pd(_mm512_cvttpd_epi32(v));
+}
+
+// processes 8 points starting at `i`, writes output starting at `o`
+__attribute__((target("avx512f"))) inline void ShadeAvx512Step(
+    const PointCloudT<double>& points,
+    std::size_t i,
+    std::size_t o,
+    const KernelParams<double>& params,
+    const ShadeOutput& out) {
+  const auto& m = params.matrix.m;
+  const __m512d x = _mm512_loadu_pd(&points.X()[i]);
+  const __m512d y = _mm512_loadu_pd(&points.Y()[i]);
+  const __m512d z = _mm512_loadu_pd(&points.Z()[i]);
+  const __m512d nx = _mm512_loadu_pd(&points.Nx()[i]);
+  const __m512d ny = _mm512_loadu_pd(&points.Ny()[i]);
+  const __m512d nz = _mm512_loadu_pd(&points.Nz()[i]);
+
+  const __m512d width = _mm512_set1_pd(params.width);
+  const __m512d height = _mm512_set1_pd(params.height);
+  const __m512d zero = _mm512_setzero_pd();
+  const __m512d one = _mm512_set1_pd(1.0);
+
+  const __m512d sx = _mm512_div_pd(
+      _mm512_add_pd(DotAvx512(m[0], x, y, z), _mm512_set1_pd(params.offset.x)),
+      _mm512_set1_pd(params.aspect_ratio));
+  const __m512d sy =
+      _mm512_add_pd(DotAvx512(m[1], x, y, z), _mm512_set1_pd(params.offset.y));
+  const __m512d sz =
+      _mm512_add_pd(DotAvx512(m[2], x, y, z), _mm512_set1_pd(params.offset.z));
+
+  const __m512d xt = TruncAvx512(_mm512_mul_pd(sx, width));
+  const __m512d yt = TruncAvx512(_mm512_mul_pd(sy, height));
+  const __mmask8 on_screen =
+      _mm512_cmp_pd_mask(xt, zero, _CMP_GE_OQ) &
+      _mm512_cmp_pd_mask(xt, _mm512_sub_pd(width, one), _CMP_LE_OQ) &
+      _mm512_cmp_pd_mask(yt, zero, _CMP_GE_OQ) &
+      _mm512_cmp_pd_mask(yt, _mm512_sub_pd(height, one), _CMP_LE_OQ);
+  __m512d cell =
+      _mm512_mask_blend_pd(on_screen, _mm512_set1_pd(kCellOffScreen),
+                           _mm512_add_pd(_mm512_mul_pd(yt, width), xt));
+  _mm512_storeu_pd(&out.depth[o], sz);
+
+  const bool world = !params.object_space;
+  const __m512d rnx = world ? DotAvx512(m[0], nx, ny, nz) : nx;
+  const __m512d rny = world ? DotAvx512(m[1], nx, ny, nz) : ny;
+  const __m512d rnz = world ? DotAvx512(m[2], nx, ny, nz) : nz;
+  if (params.cull_back_faces) {
+    const __m512d view_nz = world ? rnz : DotAvx512(m[2], nx, ny, nz);
+    const __mmask8 back =
+        on_screen & _mm512_cmp_pd_mask(view_nz, zero, _CMP_LT_OQ);
+    cell = _mm512_mask_blend_pd(back, cell, _mm512_set1_pd(kCellCulled));
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out.cell[o]),
+                      _mm512_cvttpd_epi32(cell));
+  __m512d dot = _mm512_add_pd(
+      _mm512_add_pd(_mm512_mul_pd(_mm512_set1_pd(params.light.x), rnx),
+                    _mm512_mul_pd(_mm512_set1_pd(params.light.y), rny)),
+      _mm512_mul_pd(_mm512_set1_pd(params.light.z), rnz));
+  dot = _mm512_min_pd(_mm512_max_pd(dot, zero), one);
+  const __m512d levels = _mm512_set1_pd(params.levels);
+  const __m512d light_index = _mm512_min_pd(
+      TruncAvx512(_mm512_mul_pd(dot, levels)), _mm512_sub_pd(levels, one));
+
+  const __m512i light_index_i32 =
+      _mm512_castsi256_si512(_mm512_cvttpd_epi32(light_index));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(&out.glyph[o]),
+                   _mm512_cvtepi32_epi8(light_index_i32));
+}
+
+__attribute__((target("avx512f"))) std::size_t ShadeAvx512(
+    const PointCloudT<double>& points,
+    std::size_t begin,
+    std::size_t end,
+    const KernelParams<double>& params,
+    const ShadeOutput& out) {
+  std::size_t i = begin;
+  for (; i + 16 <= end; i += 16) {
+    ShadeAvx512Step(points, i, i - begin, params, out);
+    ShadeAvx512Step(points, i + 8, i + 8 - begin, params, out);
+  }
+  return i;
+}
+
+__attribute__((target("avx512f"))) inline __m512 DotAvx512(
+    const float (&row)[3],
+    __m512 a,
+    __m512 b,
+    __m512 c) {
+  return _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(row[0]), a),
+                                     _mm512_mul_ps(_mm512_set1_ps(row[1]), b)),
+                       _mm512_mul_ps(_mm512_set1_ps(row[2]), c));
+}
+
+__attribute__((target("avx512f"))) inline __m512 TruncAvx512(__m512 v) {
+  return _mm512_cvtepi32_ps(_mm512_cvttps_epi32(v));
+}
+
+// processes 16 points starting at `i`, writes output starting at `o`
+__attribute__((target("avx512f"))) inline void ShadeAvx512Step(
+    const PointCloudT<float>& points,
+    std::size_t i,
+    std::size_t o,
+    const KernelParams<float>& params,
+    const ShadeOutput& out) {
+  const auto& m = params.matrix.m;
+  const __m512 x = _mm512_loadu_ps(&points.X()[i]);
+  const __m512 y = _mm512_loadu_ps(&points.Y()[i]);
+  const __m512 z = _mm512_loadu_ps(&points.Z()[i]);
+  const __m512 nx = _mm512_loadu_ps(&points.Nx()[i]);
+  const __m512 ny = _mm512_loadu_ps(&points.Ny()[i]);
+  const __m512 nz = _mm512_loadu_ps(&points.Nz()[i]);
+
+  const __m512 width = _mm512_set1_ps(params.width);
+  const __m512 height = _mm512_set1_ps(params.height);
+  const __m512 zero = _mm512_setzero_ps();
+  const __m512 one = _mm512_set1_ps(1.0f);
+
+  const __m512 sx = _mm512_div_ps(
+      _mm512_add_ps(DotAvx512(m[0], x, y, z), _mm512_set1_ps(params.offset.x)),
+      _mm512_set1_ps(params.aspect_ratio));
+  const __m512 sy =
+      _mm512_add_ps(DotAvx512(m[1], x, y, z), _mm512_set1_ps(params.offset.y));
+  const __m512 sz =
+      _mm512_add_ps(DotAvx512(m[2], x, y, z), _mm512_set1_ps(params.offset.z));
+
+  const __m512 xt = TruncAvx512(_mm512_mul_ps(sx, width));
+  const __m512 yt = TruncAvx512(_mm512_mul_ps(sy, height));
+  const __mmask16 on_screen =
+      _mm512_cmp_ps_mask(xt, zero, _CMP_GE_OQ) &
+      _mm512_cmp_ps_mask(xt, _mm512_sub_ps(width, one), _CMP_LE_OQ) &
+      _mm512_cmp_ps_mask(yt, zero, _CMP_GE_OQ) &
+      _mm512_cmp_ps_mask(yt, _mm512_sub_ps(height, one), _CMP_LE_OQ);
+  __m512 cell =
+      _mm512_mask_blend_ps(on_screen, _mm512_set1_ps(kCellOffScreen),
+                           _mm512_add_ps(_mm512_mul_ps(yt, width), xt));
+  _mm512_storeu_pd(&out.depth[o], _mm512_cvtps_pd(_mm512_castps512_ps256(sz)));
+  _mm512_storeu_pd(&out.depth[o + 8],
+                   _mm512_cvtps_pd(_mm256_castpd_ps(
+                       _mm512_extractf64x4_pd(_mm512_castps_pd(sz), 1))));
+
+  const bool world = !params.object_space;
+  const __m512 rnx = world ? DotAvx512(m[0], nx, ny, nz) : nx;
+  const __m512 rny = world ? DotAvx512(m[1], nx, ny, nz) : ny;
+  const __m512 rnz = world ? DotAvx512(m[2], nx, ny, nz) : nz;
+  if (params.cull_back_faces) {
+    const __m512 view_nz = world ? rnz : DotAvx512(m[2], nx, ny, nz);
+    const __mmask16 back =
+        on_screen & _mm512_cmp_ps_mask(view_nz, zero, _CMP_LT_OQ);
+    cell = _mm512_mask_blend_ps(back, cell, _mm512_set1_ps(kCellCulled));
+  }
+  _mm512_storeu_si512(&out.cell[o], _mm512_cvttps_epi32(cell));
+  __m512 dot = _mm512_add_ps(
+      _mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(params.light.x), rnx),
+                    _mm512_mul_ps(_mm512_set1_ps(params.light.y), rny)),
+      _mm512_mul_ps(_mm512_set1_ps(params.light.z), rnz));
+  dot = _mm512_min_ps(_mm512_max_ps(dot, zero), one);
+  const __m512 levels = _mm512_set1_ps(params.levels);
+  const __m512 light_index = _mm512_min_ps(
+      TruncAvx512(_mm512_mul_ps(dot, levels)), _mm512_sub_ps(levels, one));
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&out.glyph[o]),
+                   _mm512_cvtepi32_epi8(_mm512_cvttps_epi32(light_index)));
+}
+
+__attribute__((target("avx512f"))) std::size_t ShadeAvx512(
+    const PointCloudT<float>& points,
+    std::size_t begin,
+    std::size_t end,
+    const KernelParams<float>& params,
+    const ShadeOutput& out) {
+  std::size_t i = begin;
+  for (; i + 16 <= end; i += 16) {
+    ShadeAvx512Step(points, i, i - begin, params, out);
+  }
+  return i;
+}
+
+#pragma GCC diagnostic pop
+
+#endif  // DONUTCPP_CORE_SHADE_KERNEL_X86
+
+}  // namespace
+
+SimdLevel DetectSimdLevel() {
+#ifdef DONUTCPP_CORE_SHADE_KERNEL_X86
+  static const SimdLevel level = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return kSimdAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return kSimdAvx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+      return kSimdSse2;
+    }
+    return kSimdScalar;
+  }();
+  return level;
+#else
+  return kSimdScalar;
+#endif
+}
+
+const char* SimdLevelToString(SimdLevel level) {
+  switch (level) {
+    case kSimdScalar:
+      return "scalar";
+    case kSimdSse2:
+      return "sse2";
+    case kSimdAvx2:
+      return "avx2";
+    case kSimdAvx512:
+      return "avx512";
+    default:
+      return "unknown";
+  }
+}
+
+template <typename T>
+void TransformAndShade(const PointCloudT<T>& points,
+                       std::size_t begin,
+                       std::size_t end,
+                       const ShadeParams& params,
+                       const ShadeOutput& out,
+                       SimdLevel level) {
+  const KernelParams<T> kernel_params(params);
+  std::size_t done = begin;
+
+  switch (level) {
+#ifdef DONUTCPP_CORE_SHADE_KERNEL_X86
+    case kSimdAvx512:
+      done = ShadeAvx512(points, done, end, kernel_params,
+                         Advance(out, done - begin));
+      [[fallthrough]];
+    case kSimdAvx2:
+      done = ShadeAvx2(points, done, end, kernel_params,
+                       Advance(out, done - begin));
+      [[fallthrough]];
+    case kSimdSse2:
+      done = ShadeSse2(points, done, end, kernel_params,
+                       Advance(out, done - begin));
+      break;
+#else
+    case kSimdAvx512:
+    case kSimdAvx2:
+    case kSimdSse2:
+#endif
+    case kSimdScalar:
+      break;
+  }
+
+  // tail that doesn't fill a whole iteration
+  ShadeScalar(points, done, end, kernel_params, Advance(out, done - begin));
+}
+
+template void TransformAndShade(const PointCloudT<float>&,
+                                std::size_t,
+                                std::size_t,
+                                const ShadeParams&,
+                                const ShadeOutput&,
+                                SimdLevel);
+template void TransformAndShade(const PointCloudT<double>&,
+                                std::size_t,
+                                std::size_t,
+                                const ShadeParams&,
+                                const ShadeOutput&,
+                                SimdLevel);
+
+}  // namespace core
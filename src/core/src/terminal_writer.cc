@@ -0,0 +1,91 @@
+#include "core/terminal_writer.h"
+
+#include <poll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+#include "core/result.h"
+
+namespace core {
+
+TerminalWriter::TerminalWriter(int fd, std::size_t capacity) : fd_(fd) {
+  Reserve(capacity);
+}
+
+void TerminalWriter::Reserve(std::size_t capacity) {
+  buffer_.reserve(capacity);
+}
+
+Result TerminalWriter::Flush() {
+  const Result result = Write(std::string_view(buffer_));
+  buffer_.clear();
+  return result;
+}
+
+Result TerminalWriter::Write(std::string_view bytes) {
+  return Write(std::span<const std::string_view>(&bytes, 1));
+}
+
+Result TerminalWriter::Write(std::span<const std::string_view> parts) {
+  iov_.clear();
+  for (std::string_view part : parts) {
+    if (!part.empty()) {
+      iov_.push_back(iovec{
+          .iov_base = const_cast<char*>(part.data()),
+          .iov_len = part.size(),
+      });
+    }
+  }
+
+  std::size_t first = 0;
+  while (first < iov_.size()) {
+    const int count = std::min<std::size_t>(iov_.size() - first, IOV_MAX);
+    const ssize_t written = writev(fd_, &iov_[first], count);
+    ++syscalls_;
+
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        TRY_RS_ERR(WaitWritable());
+        continue;
+      }
+      return kTerminalWriteFailed;
+    }
+
+    // skips what was written, a partial write may end inside a part
+    std::size_t left = written;
+    while (first < iov_.size() && left >= iov_[first].iov_len) {
+      left -= iov_[first].iov_len;
+      ++first;
+    }
+    if (first < iov_.size()) {
+      iov_[first].iov_base = static_cast<char*>(iov_[first].iov_base) + left;
+      iov_[first].iov_len -= left;
+    }
+  }
+  return Result();
+}
+
+Result TerminalWriter::WaitWritable() const {
+  pollfd fd = {.fd = fd_, .events = POLLOUT, .revents = 0};
+  while (poll(&fd, 1, -1) < 0) {
+    if (errno != EINTR) {
+      return kTerminalWriteFailed;
+    }
+  }
+  if (fd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+    return kTerminalWriteFailed;
+  }
+  return Result();
+}
+
+}  // namespace core
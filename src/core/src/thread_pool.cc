@@ -0,0 +1,101 @@
+#include "core/thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace core {
+
+ThreadPool::ThreadPool(int thread_count) {
+  if (thread_count <= 0) {
+    thread_count = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  workers_.reserve(thread_count - 1);
+  for (int i = 0; i < thread_count - 1; ++i) {
+    workers_.emplace_back([this] { WorkerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  start_cv_.notify_all();
+
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+int ThreadPool::Size() const {
+  return workers_.size() + 1;
+}
+
+void ThreadPool::ParallelFor(int task_count,
+                             const std::function<void(int)>& task) {
+  if (task_count <= 0) {
+    return;
+  }
+
+  if (workers_.empty() || task_count == 1) {
+    for (int i = 0; i < task_count; ++i) {
+      task(i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard lock(mutex_);
+    task_ = &task;
+    task_count_ = task_count;
+    next_task_.store(0, std::memory_order_relaxed);
+    busy_workers_ = workers_.size();
+    ++generation_;
+  }
+  start_cv_.notify_all();
+
+  RunTasks();
+
+  std::unique_lock lock(mutex_);
+  done_cv_.wait(lock, [this] { return busy_workers_ == 0; });
+  task_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop() {
+  uint64_t seen_generation = 0;
+
+  while (true) {
+    {
+      std::unique_lock lock(mutex_);
+      start_cv_.wait(lock, [&] {
+        return stopping_ || generation_ != seen_generation;
+      });
+      if (stopping_) {
+        return;
+      }
+      seen_generation = generation_;
+    }
+
+    RunTasks();
+
+    {
+      std::lock_guard lock(mutex_);
+      --busy_workers_;
+    }
+    done_cv_.notify_one();
+  }
+}
+
+void ThreadPool::RunTasks() {
+  int i = next_task_.fetch_add(1, std::memory_order_relaxed);
+  while (i < task_count_) {
+    (*task_)(i);
+    i = next_task_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace core
@@ -0,0 +1,115 @@
+#include "vulkan_backend.h"
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <expected>
+#include <fstream>
+#include <ios>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "core/presenter.h"
+#include "core/result.h"
+#include "core/vulkan_renderer.h"
+
+#include "logical_device.h"
+#include "physical_device.h"
+#include "swap_chain.h"
+
+namespace core {
+
+std::expected<VulkanBackend*, Result> VulkanBackend::New(
+    const VulkanRendererConfig& config) {
+  std::unique_ptr<VulkanBackend> backend(new VulkanBackend);
+
+  glfwInit();
+
+  glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+  glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+  GLFWwindow* window = glfwCreateWindow(config.width, config.height,
+                                        "Vulkan window", nullptr, nullptr);
+
+  if (!window) {
+    return std::unexpected(kCouldNotInitializeGlfwWindow);
+  }
+  backend->window_ = window;
+
+  backend->instance_.reset(UNWRAP(Instance::New(backend->window_)));
+  backend->physical_device_.reset(
+      UNWRAP(PhysicalDevice::New(*backend->instance_)));
+  backend->device_.reset(
+      UNWRAP(LogicalDevice::New(*backend->physical_device_)));
+  backend->swap_chain_.reset(
+      UNWRAP(SwapChain::New(*backend->device_, backend->window_)));
+  TRY_RS(backend->CreateGraphicsPipeline());
+
+  backend->presenter_.Resize(config.width, config.height);
+
+  return backend.release();
+}
+
+VulkanBackend::~VulkanBackend() {
+  swap_chain_.reset();
+  device_.reset();
+  instance_.reset();
+
+  if (window_) {
+    glfwDestroyWindow(window_);
+  }
+
+  glfwTerminate();
+}
+
+std::expected<std::vector<char>, Result> VulkanBackend::ReadFile(
+    const char* filename) {
+  std::ifstream file(filename, std::ios::ate | std::ios::binary);
+
+  if (!file.is_open()) {
+    return std::unexpected(FileError{filename});
+  }
+
+  size_t file_size = (size_t)file.tellg();
+  std::vector<char> buf(file_size);
+
+  file.seekg(0);
+  file.read(buf.data(), file_size);
+
+  return buf;
+}
+
+Result VulkanBackend::CreateGraphicsPipeline() const {
+  const std::vector<char> vert_shader =
+      UNWRAP_ERR(ReadFile("shaders/shader.vert.spv"));
+  const std::vector<char> frag_shader =
+      UNWRAP_ERR(ReadFile("shaders/shader.frag.spv"));
+
+  std::cout << vert_shader.size();
+  std::cout << frag_shader.size();
+
+  return Result();
+}
+
+bool VulkanBackend::ShouldClose() {
+  return glfwWindowShouldClose(window_);
+}
+
+void VulkanBackend::PollEvents() {
+  glfwPollEvents();
+}
+
+Result VulkanBackend::Present(std::span<const char> frame) {
+  return terminal_writer_.Write(presenter_.Present(frame));
+}
+
+std::span<const char> VulkanBackend::PresentedFrame() const {
+  return presenter_.Presented();
+}
+
+const PresentStats& VulkanBackend::Stats() const {
+  return presenter_.Stats();
+}
+
+}  // namespace core
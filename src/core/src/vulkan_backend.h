@@ -0,0 +1,65 @@
+#ifndef DONUTCPP_CORE_VULKAN_BACKEND_H_
+#define DONUTCPP_CORE_VULKAN_BACKEND_H_
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <expected>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "core/presenter.h"
+#include "core/result.h"
+#include "core/terminal_writer.h"
+#include "core/vulkan_renderer.h"
+
+#include "instance.h"
+#include "logical_device.h"
+#include "physical_device.h"
+#include "render_backend.h"
+#include "swap_chain.h"
+
+namespace core {
+
+// GLFW window with the vulkan device, frames are drawn to the terminal
+class VulkanBackend : public RenderBackend {
+ public:
+  static std::expected<VulkanBackend*, Result> New(
+      const VulkanRendererConfig& config);
+
+  VulkanBackend(const VulkanBackend&) = delete;
+  VulkanBackend(VulkanBackend&&) = delete;
+  VulkanBackend& operator=(const VulkanBackend&) = delete;
+  VulkanBackend& operator=(VulkanBackend&&) = delete;
+  ~VulkanBackend() override;
+
+  bool ShouldClose() override;
+  void PollEvents() override;
+  Result Present(std::span<const char> frame) override;
+
+  std::span<const char> PresentedFrame() const override;
+  const PresentStats& Stats() const override;
+
+ private:
+  VulkanBackend() = default;
+
+  static std::expected<std::vector<char>, Result> ReadFile(
+      const char* filename);
+  Result CreateGraphicsPipeline() const;
+
+  // vulkan members
+  GLFWwindow* window_ = nullptr;
+  std::unique_ptr<Instance> instance_;
+  std::unique_ptr<PhysicalDevice> physical_device_;
+  std::unique_ptr<LogicalDevice> device_;
+  std::unique_ptr<SwapChain> swap_chain_;
+
+  // sends only what changed since the last drawn frame
+  Presenter presenter_;
+  TerminalWriter terminal_writer_;
+};
+
+}  // namespace core
+
+#endif  // DONUTCPP_CORE_VULKAN_BACKEND_H_
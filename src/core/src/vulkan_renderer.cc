@@ -1,12 +1,17 @@
 #include "core/vulkan_renderer.h"
 
-#define GLFW_INCLUDE_VULKAN
-#include <GLFW/glfw3.h>
-
 #include <chrono>
 #include <expected>
 #include <memory>
-
+#include <memory_resource>
+#include <span>
+
+#include "core/epoch_framebuffer.h"
+#include "core/frame_pacer.h"
+#include "core/frame_stats.h"
+#include "core/framebuffer.h"
+#include "core/packed_framebuffer.h"
+#include "core/presenter.h"
 #include "core/result.h"
 
 #include "vulkan_renderer_impl.h"
@@ -15,30 +20,64 @@ namespace core {
 
 std::expected<VulkanRenderer*, Result> VulkanRenderer::New(
     const VulkanRendererConfig& config) {
-  std::unique_ptr<VulkanRenderer> rend(new VulkanRenderer);
+  std::unique_ptr<VulkanRenderer> rend(
+      new VulkanRenderer(config.memory_resource
+                             ? config.memory_resource
+                             : std::pmr::get_default_resource()));
 
   TRY_RS(rend->d->New(config));
 
   return rend.release();
 }
 
-VulkanRenderer::VulkanRenderer() : d(std::make_unique<Impl>()) {}
+VulkanRenderer::VulkanRenderer(std::pmr::memory_resource* resource)
+    : d(std::make_unique<Impl>(resource)) {}
 
 VulkanRenderer::~VulkanRenderer() = default;
 
 void VulkanRenderer::Start() {
-  d->Start();
+  d->Start(*this);
+}
+
+void VulkanRenderer::Stop() {
+  d->stop_requested_.store(true, std::memory_order_relaxed);
+}
+
+std::expected<BatchReport, Result> VulkanRenderer::RenderBatch(
+    const BatchConfig& config) {
+  return d->RenderBatch(*this, config);
+}
+
+void VulkanRenderer::BeginStage(FrameStage stage) {
+  d->MarkStage(stage);
 }
 
 void VulkanRenderer::Clear() {
-  for (int i = 0; i < d->cfg_.width * d->cfg_.height; ++i) {
-    d->buffer_[i] = ' ';
-    d->z_buffer_[i] = 0.0;
+  switch (d->cfg_.framebuffer_mode) {
+    case kFramebufferDepth:
+      d->framebuffer_.Clear();
+      break;
+    case kFramebufferPacked:
+      d->packed_framebuffer_.Clear();
+      break;
+    case kFramebufferEpoch:
+      d->epoch_framebuffer_.Clear();
+      break;
   }
 }
 
 void VulkanRenderer::Put(int x, int y, char sym) {
-  d->buffer_[Xy(x, y)] = sym;
+  switch (d->cfg_.framebuffer_mode) {
+    case kFramebufferDepth:
+      d->framebuffer_.Put(Xy(x, y), sym);
+      break;
+    case kFramebufferPacked:
+      d->packed_framebuffer_.Put(Xy(x, y), sym);
+      break;
+    case kFramebufferEpoch:
+      d->epoch_framebuffer_.Put(Xy(x, y), sym);
+      break;
+  }
 }
 
 void VulkanRenderer::Put(const core::Vec3& point, char sym) {
@@ -51,12 +90,85 @@ void VulkanRenderer::Put(const core::Vec3& point, char sym) {
     return;
   }
 
-  if (d->z_buffer_[Xy(x_denorm, y_denorm)] < point.z) {
-    d->z_buffer_[Xy(x_denorm, y_denorm)] = point.z;
-    d->buffer_[Xy(x_denorm, y_denorm)] = sym;
+  PutAt(Xy(x_denorm, y_denorm), point.z, sym);
+}
+
+void VulkanRenderer::PutAt(int index, double depth, char sym) {
+  switch (d->cfg_.framebuffer_mode) {
+    case kFramebufferDepth:
+      d->framebuffer_.PutAt(index, depth, sym);
+      break;
+    case kFramebufferPacked:
+      d->packed_framebuffer_.PutAt(index, depth, sym);
+      break;
+    case kFramebufferEpoch:
+      d->epoch_framebuffer_.PutAt(index, depth, sym);
+      break;
+  }
+}
+
+void VulkanRenderer::PutRun(int index, int length, double depth, char sym) {
+  const int end = index + length;
+  switch (d->cfg_.framebuffer_mode) {
+    case kFramebufferDepth:
+      for (int i = index; i < end; ++i) {
+        d->framebuffer_.PutAt(i, depth, sym);
+      }
+      break;
+    case kFramebufferPacked:
+      for (int i = index; i < end; ++i) {
+        d->packed_framebuffer_.PutAt(i, depth, sym);
+      }
+      break;
+    case kFramebufferEpoch:
+      for (int i = index; i < end; ++i) {
+        d->epoch_framebuffer_.PutAt(i, depth, sym);
+      }
+      break;
   }
 }
 
+std::span<const char> VulkanRenderer::ResolveChars() {
+  d->ResolveFrame();
+  return d->framebuffer_.Chars();
+}
+
+Framebuffer& VulkanRenderer::GetFramebuffer() {
+  return d->framebuffer_;
+}
+
+PackedFramebuffer& VulkanRenderer::GetPackedFramebuffer() {
+  return d->packed_framebuffer_;
+}
+
+EpochFramebuffer& VulkanRenderer::GetEpochFramebuffer() {
+  return d->epoch_framebuffer_;
+}
+
+const PresentStats& VulkanRenderer::GetPresentStats() const {
+  return d->backend_->Stats();
+}
+
+int64_t VulkanRenderer::GetDroppedFrames() const {
+  return d->frame_ring_.Dropped();
+}
+
+const FrameStats& VulkanRenderer::GetFrameStats() const {
+  return d->frame_stats_;
+}
+
+const PacerStats& VulkanRenderer::GetPacerStats() const {
+  return d->pacer_.Stats();
+}
+
+std::span<const char> VulkanRenderer::GetPresentedFrame() const {
+  return d->backend_->PresentedFrame();
+}
+
+FramebufferMode VulkanRenderer::GetFramebufferMode() const {
+  return d->cfg_.framebuffer_mode;
+}
+
 int VulkanRenderer::GetWidth() const {
   return d->cfg_.width;
 }
@@ -86,9 +198,7 @@ double VulkanRenderer::ToAspect(double val) const {
 }
 
 double VulkanRenderer::NsToSeconds(std::chrono::nanoseconds ns) const {
-  const long count =
-      std::chrono::duration_cast<std::chrono::milliseconds, long>(ns).count();
-  return count / 1000.0;
+  return std::chrono::duration<double>(ns).count();
 }
 
 double VulkanRenderer::TimeLived() const {
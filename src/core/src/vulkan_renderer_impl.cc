@@ -1,127 +1,236 @@
 #include "vulkan_renderer_impl.h"
 #include "core/vulkan_renderer.h"
 
-#define GLFW_INCLUDE_VULKAN
-#include <GLFW/glfw3.h>
+#include <signal.h>
 
-#include <sys/ioctl.h>
-#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <expected>
-#include <fstream>
-#include <ios>
 #include <iostream>
 #include <memory>
 #include <thread>
-#include <vector>
 
-#include "logical_device.h"
-#include "physical_device.h"
-#include "swap_chain.h"
+#include "core/frame_pacer.h"
+#include "core/frame_sink.h"
+#include "core/frame_stats.h"
+
+#include "headless_backend.h"
+#include "vulkan_backend.h"
 
 namespace core {
 
-Result VulkanRenderer::Impl::New(const VulkanRendererConfig& config) {
-  glfwInit();
+namespace {
 
-  glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-  glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
-  GLFWwindow* window = glfwCreateWindow(config.width, config.height,
-                                        "Vulkan window", nullptr, nullptr);
+// set from the SIGUSR1 handler, the render loop does the writing
+std::atomic<bool> g_dump_frame_stats = false;
 
-  if (!window) {
-    return kCouldNotInitializeGlfwWindow;
-  }
-  window_ = window;
+void RequestFrameStatsDump(int) {
+  g_dump_frame_stats.store(true, std::memory_order_relaxed);
+}
 
-  instance_.reset(UNWRAP_ERR(Instance::New(window_)));
-  physical_device_.reset(UNWRAP_ERR(PhysicalDevice::New(*instance_)));
-  device_.reset(UNWRAP_ERR(LogicalDevice::New(*physical_device_)));
-  swap_chain_.reset(UNWRAP_ERR(SwapChain::New(*device_, window_)));
-  TRY_RS_ERR(CreateGraphicsPipeline());
+int64_t Nanoseconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+      .count();
+}
+
+}  // namespace
+
+Result VulkanRenderer::Impl::New(const VulkanRendererConfig& config) {
+  switch (config.backend) {
+    case kBackendVulkan:
+      backend_.reset(UNWRAP_ERR(VulkanBackend::New(config)));
+      break;
+    case kBackendHeadless:
+      backend_ = std::make_unique<HeadlessBackend>(config.width, config.height);
+      break;
+  }
 
   cfg_ = config;
-  buffer_.resize(config.width * config.height);
-  z_buffer_.resize(config.width * config.height);
+  framebuffer_.Resize(config.width, config.height);
+  switch (config.framebuffer_mode) {
+    case kFramebufferDepth:
+      break;
+    case kFramebufferPacked:
+      packed_framebuffer_.Resize(config.width, config.height);
+      break;
+    case kFramebufferEpoch:
+      epoch_framebuffer_.Resize(config.width, config.height);
+      break;
+  }
+  if (config.present_mode == kPresentThread) {
+    frame_ring_.Resize(config.width * config.height);
+  }
   screen_ratio_ = config.width / (double)config.height;
-  target_ns_ =
-      std::chrono::nanoseconds(std::chrono::seconds(1)) / config.target_fps;
+  target_ns_ = std::chrono::nanoseconds(0);
+  if (config.target_fps > 0) {
+    target_ns_ =
+        std::chrono::nanoseconds(std::chrono::seconds(1)) / config.target_fps;
+  }
+  pacer_ = FramePacer(target_ns_, std::chrono::microseconds(config.spin_us),
+                      config.overrun_policy);
 
   return Result();
 }
 
-VulkanRenderer::Impl::~Impl() {
-  swap_chain_.reset();
-  device_.reset();
-  instance_.reset();
+void VulkanRenderer::Impl::Start(VulkanRenderer& renderer) {
+  double delta = renderer.NsToSeconds(target_ns_);
+  start_time_ = std::chrono::system_clock::now().time_since_epoch();
 
-  if (window_) {
-    glfwDestroyWindow(window_);
+  std::thread present_thread;
+  if (cfg_.present_mode == kPresentThread) {
+    present_failed_.store(false, std::memory_order_relaxed);
+    present_thread = std::thread(&Impl::PresentLoop, this);
   }
 
-  glfwTerminate();
-}
+  struct sigaction previous_action = {};
+  if (cfg_.frame_stats_path) {
+    struct sigaction action = {};
+    action.sa_handler = RequestFrameStatsDump;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGUSR1, &action, &previous_action);
+  }
 
-std::expected<std::vector<char>, Result> VulkanRenderer::Impl::ReadFile(
-    const char* filename) {
-  std::ifstream file(filename, std::ios::ate | std::ios::binary);
+  stop_requested_.store(false, std::memory_order_relaxed);
+  pacer_.Start();
+  for (int64_t frame = 0; cfg_.max_frames == 0 || frame < cfg_.max_frames;
+       ++frame) {
+    if (stop_requested_.load(std::memory_order_relaxed) ||
+        backend_->ShouldClose()) {
+      break;
+    }
+    const std::chrono::steady_clock::time_point frame_begin =
+        std::chrono::steady_clock::now();
+    RenderFrame(renderer, delta);
+    backend_->PollEvents();
+    MarkStage(kStagePresent);
+    if (cfg_.present_mode == kPresentThread) {
+      ResolveFrame();
+      // the ring drops frames the presenter didn't take, the recording
+      // must not
+      if (cfg_.recorder && !cfg_.recorder->Consume(framebuffer_.Chars())) {
+        break;
+      }
+      std::ranges::copy(framebuffer_.Chars(), frame_ring_.Back().begin());
+      frame_ring_.Publish();
+      if (present_failed_.load(std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (!DrawBuffer()) {
+      // the terminal or the recording is gone
+      break;
+    }
+    MarkStage(kStageIdle);
+    delta = pacer_.Wait();
+    const std::chrono::steady_clock::time_point frame_end =
+        std::chrono::steady_clock::now();
+    frame_stats_.stages[kStageIdle].Record(
+        Nanoseconds(frame_end - stage_begin_));
+    frame_stats_.frames.Record(Nanoseconds(frame_end - frame_begin));
+
+    if (g_dump_frame_stats.exchange(false, std::memory_order_relaxed)) {
+      DumpFrameStats();
+    }
+  }
 
-  if (!file.is_open()) {
-    return std::unexpected(FileError{filename});
+  if (present_thread.joinable()) {
+    frame_ring_.Close();
+    present_thread.join();
+  }
+  if (cfg_.frame_stats_path) {
+    sigaction(SIGUSR1, &previous_action, nullptr);
+    DumpFrameStats();
   }
+}
 
-  size_t file_size = (size_t)file.tellg();
-  std::vector<char> buf(file_size);
+std::expected<BatchReport, Result> VulkanRenderer::Impl::RenderBatch(
+    VulkanRenderer& renderer,
+    const BatchConfig& config) {
+  BatchReport report;
+  const std::chrono::steady_clock::time_point begin =
+      std::chrono::steady_clock::now();
+
+  for (; report.frames < config.frames; ++report.frames) {
+    const std::chrono::steady_clock::time_point frame_begin =
+        std::chrono::steady_clock::now();
+    RenderFrame(renderer, config.delta);
+    if (cfg_.render_handler) {
+      report.points += cfg_.render_handler->LastPointCount();
+    }
+    MarkStage(kStagePresent);
+    ResolveFrame();
+    if (config.sink) {
+      TRY_RS(config.sink->Consume(framebuffer_.Chars()));
+    }
 
-  file.seekg(0);
-  file.read(buf.data(), file_size);
+    const std::chrono::steady_clock::time_point frame_end =
+        std::chrono::steady_clock::now();
+    frame_stats_.stages[kStagePresent].Record(
+        Nanoseconds(frame_end - stage_begin_));
+    frame_stats_.frames.Record(Nanoseconds(frame_end - frame_begin));
+  }
 
-  return buf;
+  report.elapsed = std::chrono::steady_clock::now() - begin;
+  return report;
 }
 
-Result VulkanRenderer::Impl::CreateGraphicsPipeline() const {
-  const std::vector<char> vert_shader =
-      UNWRAP_ERR(ReadFile("shaders/shader.vert.spv"));
-  const std::vector<char> frag_shader =
-      UNWRAP_ERR(ReadFile("shaders/shader.frag.spv"));
-
-  std::cout << vert_shader.size();
-  std::cout << frag_shader.size();
+void VulkanRenderer::Impl::RenderFrame(VulkanRenderer& renderer,
+                                       double delta) {
+  stage_ = kStageClear;
+  stage_begin_ = std::chrono::steady_clock::now();
+  renderer.Clear();
+  MarkStage(kStageSimulate);
+  if (cfg_.render_handler) {
+    cfg_.render_handler->Render(delta, renderer);
+  }
+}
 
-  return Result();
+void VulkanRenderer::Impl::MarkStage(FrameStage stage) {
+  const std::chrono::steady_clock::time_point now =
+      std::chrono::steady_clock::now();
+  frame_stats_.stages[stage_].Record(Nanoseconds(now - stage_begin_));
+  stage_ = stage;
+  stage_begin_ = now;
 }
 
-void VulkanRenderer::Impl::Start() {
-  std::chrono::nanoseconds frame_time = target_ns_;
-  // double delta = NsToSeconds(target_ns_);
-  start_time_ = std::chrono::system_clock::now().time_since_epoch();
+void VulkanRenderer::Impl::DumpFrameStats() const {
+  const Result result =
+      frame_stats_.WriteFile(cfg_.frame_stats_path, cfg_.frame_stats_format);
+  if (!result) {
+    std::cerr << ResultToString(result) << std::endl;
+  }
+}
 
-  while (!glfwWindowShouldClose(window_)) {
-    std::chrono::time_point before_render =
-        std::chrono::high_resolution_clock::now();
-    // Clear();
-    // Render(delta);
-    glfwPollEvents();
-    // DrawBuffer();
-    std::chrono::time_point after_render =
-        std::chrono::high_resolution_clock::now();
-    frame_time = after_render - before_render;
-    // delta = frame_time > target_ns_ ? NsToSeconds(frame_time)
-    //                                 : NsToSeconds(target_ns_);
-
-    if (frame_time < target_ns_) {
-      std::this_thread::sleep_for(target_ns_ - frame_time);
+void VulkanRenderer::Impl::PresentLoop() {
+  while (frame_ring_.WaitAcquire()) {
+    if (!backend_->Present(frame_ring_.Front())) {
+      present_failed_.store(true, std::memory_order_relaxed);
+      return;
     }
   }
 }
 
-void VulkanRenderer::Impl::DrawBuffer() const {
-  MoveCursorTo(0, 0);
-  std::cout.write(buffer_.data(), buffer_.size());
-  std::cout.flush();
+void VulkanRenderer::Impl::ResolveFrame() {
+  switch (cfg_.framebuffer_mode) {
+    case kFramebufferDepth:
+      break;
+    case kFramebufferPacked:
+      packed_framebuffer_.Resolve(framebuffer_);
+      break;
+    case kFramebufferEpoch:
+      epoch_framebuffer_.ResolveChars(framebuffer_.Chars());
+      break;
+  }
 }
 
-void VulkanRenderer::Impl::MoveCursorTo(int x, int y) const {
-  printf("\033[%d;%dH", y, x);
+Result VulkanRenderer::Impl::DrawBuffer() {
+  ResolveFrame();
+  TRY_RS_ERR(backend_->Present(framebuffer_.Chars()));
+  if (cfg_.recorder) {
+    return cfg_.recorder->Consume(framebuffer_.Chars());
+  }
+  return Result();
 }
 
 }  // namespace core
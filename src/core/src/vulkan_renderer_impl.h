@@ -1,59 +1,75 @@
 #ifndef DONUTCPP_CORE_VULKAN_RENDERER_IMPL_H_
 #define DONUTCPP_CORE_VULKAN_RENDERER_IMPL_H_
 
-#define GLFW_INCLUDE_VULKAN
-#include <GLFW/glfw3.h>
-
+#include <atomic>
 #include <chrono>
 #include <expected>
 #include <memory>
-#include <vector>
-
+#include <memory_resource>
+
+#include "core/epoch_framebuffer.h"
+#include "core/frame_pacer.h"
+#include "core/frame_ring.h"
+#include "core/frame_stats.h"
+#include "core/framebuffer.h"
+#include "core/packed_framebuffer.h"
 #include "core/vulkan_renderer.h"
 
-#include "instance.h"
-#include "logical_device.h"
-#include "physical_device.h"
-#include "swap_chain.h"
+#include "render_backend.h"
 
 namespace core {
 
 struct VulkanRenderer::Impl {
   Result New(const VulkanRendererConfig& config);
-  Impl() = default;
+  explicit Impl(std::pmr::memory_resource* resource)
+      : framebuffer_(resource) {}
   Impl(const Impl&) = delete;
   Impl(Impl&&) = delete;
   Impl& operator=(const Impl&) = delete;
   Impl& operator=(Impl&&) = delete;
-  ~Impl();
-
-  // vulkan stuff
-  static std::expected<std::vector<char>, Result> ReadFile(
-      const char* filename);
-  Result CreateGraphicsPipeline() const;
-
-  // other stuff
-  void Start();
-
-  void DrawBuffer() const;
-
-  void MoveCursorTo(int x, int y) const;
+  ~Impl() = default;
+
+  void Start(VulkanRenderer& renderer);
+  std::expected<BatchReport, Result> RenderBatch(VulkanRenderer& renderer,
+                                                 const BatchConfig& config);
+  // clears, calls the render handler and resolves the frame
+  void RenderFrame(VulkanRenderer& renderer, double delta);
+
+  // resolves the frame into framebuffer_ whatever the framebuffer mode
+  void ResolveFrame();
+  Result DrawBuffer();
+  // kPresentThread consumer loop
+  void PresentLoop();
+  // records the running stage and starts `stage`
+  void MarkStage(FrameStage stage);
+  void DumpFrameStats() const;
 
   VulkanRendererConfig cfg_ = {};
 
-  // vulkan members
-  GLFWwindow* window_ = nullptr;
-  std::unique_ptr<Instance> instance_;
-  std::unique_ptr<PhysicalDevice> physical_device_;
-  std::unique_ptr<LogicalDevice> device_;
-  std::unique_ptr<SwapChain> swap_chain_;
+  // window and output of the frames
+  std::unique_ptr<RenderBackend> backend_;
 
   // other members
-  std::vector<char> buffer_;
-  std::vector<double> z_buffer_;
+  Framebuffer framebuffer_;
+  // used instead of framebuffer_ in kFramebufferPacked mode, resolved into it
+  // before drawing
+  PackedFramebuffer packed_framebuffer_;
+  // used instead of framebuffer_ in kFramebufferEpoch mode, only its chars
+  // are resolved into framebuffer_ before drawing
+  EpochFramebuffer epoch_framebuffer_;
+  // hands resolved frames to the presenter thread in kPresentThread mode
+  FrameRing frame_ring_;
+  // set by the presenter thread once the terminal or the recording is gone
+  std::atomic<bool> present_failed_ = false;
+  std::atomic<bool> stop_requested_ = false;
   double screen_ratio_ = 0.0;
 
+  FrameStats frame_stats_;
+  FrameStage stage_ = kStageClear;
+  std::chrono::steady_clock::time_point stage_begin_;
+
   std::chrono::nanoseconds target_ns_;
+  FramePacer pacer_;
   std::chrono::nanoseconds start_time_;
 };
 
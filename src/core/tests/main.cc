@@ -1,16 +1,127 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 
 #include <doctest.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <memory_resource>
 #include <numbers>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
+#include "core/epoch_framebuffer.h"
+#include "core/frame_cache.h"
+#include "core/frame_pacer.h"
+#include "core/frame_recorder.h"
+#include "core/frame_ring.h"
+#include "core/frame_sink.h"
+#include "core/frame_stats.h"
+#include "core/framebuffer.h"
+#include "core/latency_histogram.h"
+#include "core/packed_framebuffer.h"
+#include "core/parallel_raster.h"
+#include "core/presenter.h"
+#include "core/point_cloud.h"
+#include "core/point_info.h"
 #include "core/quaternion.h"
 #include "core/rotation.h"
+#include "core/shade_kernel.h"
+#include "core/terminal_writer.h"
+#include "core/thread_pool.h"
 #include "core/vec3.h"
+#include "core/vulkan_renderer.h"
 
 using namespace std::numbers;
 using namespace core;
 
+// deterministic cloud around the origin with unit normals
+template <typename T = double>
+static PointCloudT<T> MakeTestCloud(size_t size) {
+  PointCloudT<T> cloud(size);
+  for (size_t i = 0; i < size; ++i) {
+    const double t = i * 0.37;
+    const Vec3 p{0.7 * sin(t), 0.6 * cos(t * 1.3), 0.5 * sin(t * 0.7)};
+    const Vec3 normal = Vec3{cos(t), sin(t * 2.1), cos(t * 0.3)}.Normalized();
+    cloud.Set(i, PointInfoT<T>{.p = p.As<T>(), .normal = normal.As<T>()});
+  }
+  return cloud;
+}
+
+// closed torus around the origin like the app's donut
+static PointCloud MakeTestTorus(double r1, double r2, int precision) {
+  PointCloud cloud(precision * precision);
+  const double step = 2 * pi / precision;
+  for (int major = 0; major < precision; ++major) {
+    for (int minor = 0; minor < precision; ++minor) {
+      const Vec3 normal{cos(step * minor) * cos(step * major),
+                        sin(step * minor),
+                        -cos(step * minor) * sin(step * major)};
+      const Vec3 p{(r1 + r2 * cos(step * minor)) * cos(step * major),
+                   r2 * sin(step * minor),
+                   -(r1 + r2 * cos(step * minor)) * sin(step * major)};
+      cloud.Set(major * precision + minor, PointInfo{.p = p, .normal = normal});
+    }
+  }
+  return cloud;
+}
+
+// applies cursor moves "\033[r;cH", "\033[H", "\033[nC" and chars to
+// `screen` like a terminal with line wrapping would
+static void ApplyTerminalOutput(std::string_view output,
+                                int width,
+                                std::vector<char>& screen) {
+  int pos = 0;
+  size_t i = 0;
+  while (i < output.size()) {
+    if (output[i] != '\033') {
+      screen[pos++] = output[i++];
+      continue;
+    }
+    i += 2;
+    int numbers[2] = {0, 0};
+    int count = 0;
+    for (; (output[i] >= '0' && output[i] <= '9') || output[i] == ';'; ++i) {
+      if (output[i] == ';') {
+        ++count;
+      } else {
+        numbers[count] = numbers[count] * 10 + (output[i] - '0');
+      }
+    }
+    if (output[i] == 'H') {
+      pos = numbers[0] == 0 ? 0 : (numbers[0] - 1) * width + numbers[1] - 1;
+    } else if (output[i] == 'C') {
+      pos += numbers[0];
+    }
+    ++i;
+  }
+}
+
+static ShadeParams MakeTestShadeParams() {
+  const Rotation rotation = Rotation({0.1, 0.2, 0.5}, 1.1)
+                                .Then(Rotation({0.7, 0.7, -0.5}, 0.22));
+  return ShadeParams{
+      .matrix = rotation.Matrix(),
+      .offset = rotation.Offset() + Vec3{0.5, 0.5, 0.5},
+      .aspect_ratio = 800.0 / 600.0,
+      .light = Vec3{-1.0, -1.0, 3.0}.Normalized(),
+      .light_level_count = 12,
+      .width = 80,
+      .height = 60,
+  };
+}
+
 TEST_CASE("From Axis And Angle") {
   const Vec3 axis{1.0, 0.0, 0.0};
   const Quat q = Quat::FromAxisAndAngle(axis, pi / 2.0);
@@ -204,3 +315,1269 @@ TEST_CASE("Vec3 Negate") {
   CHECK_EQ(neg_v.y, doctest::Approx(-v.y));
   CHECK_EQ(neg_v.z, doctest::Approx(-v.z));
 }
+
+TEST_CASE("Rotation matches Rotate") {
+  const Vec3 point{2.0, 1.0, 3.0};
+  const Vec3 axis{0.1, 0.2, 0.5};
+  const Vec3 center{0.5, -1.0, 2.0};
+  const double angle = 1.3;
+
+  const Vec3 expected = Rotate(point, axis, angle, center);
+  const Vec3 rotated = Rotation(axis, angle, center).Apply(point);
+
+  CHECK_EQ(rotated.x, doctest::Approx(expected.x));
+  CHECK_EQ(rotated.y, doctest::Approx(expected.y));
+  CHECK_EQ(rotated.z, doctest::Approx(expected.z));
+}
+
+TEST_CASE("Rotation on zeroth Axis is identity") {
+  const Vec3 p{1, 2, 3};
+
+  const Vec3 rotated = Rotation({0, 0, 0}, pi / 2.0).Apply(p);
+
+  CHECK_EQ(rotated.x, doctest::Approx(p.x));
+  CHECK_EQ(rotated.y, doctest::Approx(p.y));
+  CHECK_EQ(rotated.z, doctest::Approx(p.z));
+}
+
+TEST_CASE("Rotation Then") {
+  const Vec3 point{2.0, 1.0, 3.0};
+  const Vec3 axis1{0.1, 0.2, 0.5};
+  const Vec3 axis2{0.7, 0.7, -0.5};
+  const Vec3 center{0.0, 1.0, 0.0};
+
+  const Vec3 expected =
+      Rotate(Rotate(point, axis1, 0.7, center), axis2, -2.1);
+  const Vec3 rotated =
+      Rotation(axis1, 0.7, center).Then(Rotation(axis2, -2.1)).Apply(point);
+
+  CHECK_EQ(rotated.x, doctest::Approx(expected.x));
+  CHECK_EQ(rotated.y, doctest::Approx(expected.y));
+  CHECK_EQ(rotated.z, doctest::Approx(expected.z));
+}
+
+TEST_CASE("Rotation ApplyToDirection ignores center") {
+  const Vec3 normal{1.0, 0.0, 0.0};
+  const Vec3 z_axis{0.0, 0.0, 1.0};
+
+  const Vec3 rotated =
+      Rotation(z_axis, pi / 2.0, {5.0, 5.0, 5.0}).ApplyToDirection(normal);
+
+  CHECK_EQ(rotated.x, doctest::Approx(0.0));
+  CHECK_EQ(rotated.y, doctest::Approx(1.0));
+  CHECK_EQ(rotated.z, doctest::Approx(0.0));
+}
+
+TEST_CASE("RotateMany") {
+  const Vec3 in[] = {{2.0, 1.0, 3.0}, {-1.0, 0.5, 0.0}, {0.0, 0.0, 0.0}};
+  const Vec3 axis{1.0, 1.0, 0.0};
+  const Vec3 center{0.0, 0.0, 1.0};
+  Vec3 out[3];
+
+  RotateMany(in, out, axis, pi / 3.0, center);
+
+  for (int i = 0; i < 3; ++i) {
+    const Vec3 expected = Rotate(in[i], axis, pi / 3.0, center);
+    CHECK_EQ(out[i].x, doctest::Approx(expected.x));
+    CHECK_EQ(out[i].y, doctest::Approx(expected.y));
+    CHECK_EQ(out[i].z, doctest::Approx(expected.z));
+  }
+}
+
+TEST_CASE("PointCloud Set and AoS view") {
+  PointCloud cloud(3);
+  const PointInfo pi{.p = {1.0, 2.0, 3.0}, .normal = {0.0, 1.0, 0.0}};
+
+  cloud.Set(1, pi);
+
+  CHECK_EQ(cloud.Size(), 3);
+  CHECK_EQ(cloud.X()[1], doctest::Approx(1.0));
+  CHECK_EQ(cloud.Y()[1], doctest::Approx(2.0));
+  CHECK_EQ(cloud.Z()[1], doctest::Approx(3.0));
+  CHECK_EQ(cloud.Ny()[1], doctest::Approx(1.0));
+  CHECK_EQ(cloud[1].p.z, doctest::Approx(pi.p.z));
+  CHECK_EQ(cloud[1].normal.y, doctest::Approx(pi.normal.y));
+
+  int count = 0;
+  for (const PointInfo& point : cloud) {
+    CHECK_EQ(point.p.x, doctest::Approx(count == 1 ? 1.0 : 0.0));
+    ++count;
+  }
+  CHECK_EQ(count, 3);
+}
+
+TEST_CASE("PointCloud arrays are aligned") {
+  PointCloud cloud(5);
+
+  for (const std::span<const double> arr :
+       {cloud.X(), cloud.Y(), cloud.Z(), cloud.Nx(), cloud.Ny(), cloud.Nz()}) {
+    CHECK_EQ(reinterpret_cast<uintptr_t>(arr.data()) % PointCloud::kAlignment,
+             0);
+  }
+}
+
+TEST_CASE("TransformAndShade matches per-point transform") {
+  const PointCloud cloud = MakeTestCloud(257);
+  const ShadeParams params = MakeTestShadeParams();
+  std::vector<int32_t> cells(cloud.Size());
+  std::vector<double> depths(cloud.Size());
+  std::vector<uint8_t> glyphs(cloud.Size());
+
+  TransformAndShade(cloud, params, {cells, depths, glyphs}, kSimdScalar);
+
+  for (size_t i = 0; i < cloud.Size(); ++i) {
+    Vec3 p = params.matrix * cloud.Position(i) + params.offset;
+    p.x /= params.aspect_ratio;
+    const int x = (int)(p.x * params.width);
+    const int y = (int)(p.y * params.height);
+    const bool on_screen =
+        x >= 0 && x < params.width && y >= 0 && y < params.height;
+
+    const Vec3 normal = params.matrix * cloud.Normal(i);
+    const double dot = std::min(std::max(params.light.Dot(normal), 0.0), 1.0);
+    const int light_index =
+        std::min((int)(dot * params.light_level_count),
+                 params.light_level_count - 1);
+
+    CHECK_EQ(cells[i], on_screen ? y * params.width + x : -1);
+    CHECK_EQ(depths[i], p.z);
+    CHECK_EQ(glyphs[i], light_index);
+  }
+}
+
+TEST_CASE("TransformAndShade SIMD levels match scalar") {
+  const PointCloud cloud = MakeTestCloud(1003);
+  const ShadeParams params = MakeTestShadeParams();
+  std::vector<int32_t> cells(cloud.Size());
+  std::vector<double> depths(cloud.Size());
+  std::vector<uint8_t> glyphs(cloud.Size());
+
+  TransformAndShade(cloud, params, {cells, depths, glyphs}, kSimdScalar);
+
+  for (int level = kSimdSse2; level <= DetectSimdLevel(); ++level) {
+    std::vector<int32_t> simd_cells(cloud.Size());
+    std::vector<double> simd_depths(cloud.Size());
+    std::vector<uint8_t> simd_glyphs(cloud.Size());
+
+    TransformAndShade(cloud, 3, cloud.Size(), params,
+                      {simd_cells, simd_depths, simd_glyphs},
+                      (SimdLevel)level);
+
+    for (size_t i = 3; i < cloud.Size(); ++i) {
+      CHECK_EQ(simd_cells[i - 3], cells[i]);
+      CHECK_EQ(simd_depths[i - 3], depths[i]);
+      CHECK_EQ(simd_glyphs[i - 3], glyphs[i]);
+    }
+  }
+}
+
+TEST_CASE("TransformAndShade object space lighting matches world space") {
+  const PointCloud cloud = MakeTestCloud(20000);
+  ShadeParams params = MakeTestShadeParams();
+  std::vector<int32_t> cells(cloud.Size());
+  std::vector<double> depths(cloud.Size());
+  std::vector<uint8_t> glyphs(cloud.Size());
+
+  TransformAndShade(cloud, params, {cells, depths, glyphs}, kSimdScalar);
+
+  params.lighting = kLightingObjectSpace;
+  for (int level = kSimdScalar; level <= DetectSimdLevel(); ++level) {
+    std::vector<int32_t> object_cells(cloud.Size());
+    std::vector<double> object_depths(cloud.Size());
+    std::vector<uint8_t> object_glyphs(cloud.Size());
+
+    TransformAndShade(cloud, params,
+                      {object_cells, object_depths, object_glyphs},
+                      (SimdLevel)level);
+
+    CHECK(object_cells == cells);
+    CHECK(object_depths == depths);
+    CHECK(object_glyphs == glyphs);
+  }
+}
+
+TEST_CASE("Float Rotate matches double") {
+  const Vec3 point{0.3, -0.4, 0.2};
+  const Vec3 axis{0.1, 0.2, 0.5};
+  const Vec3 center{0.25, 0.0, 0.0};
+  const Vec3 expected = Rotate(point, axis, 1.1, center);
+  const Vec3f result =
+      Rotate(point.As<float>(), axis.As<float>(), 1.1f, center.As<float>());
+
+  CHECK_EQ(result.x, doctest::Approx(expected.x).epsilon(1e-5));
+  CHECK_EQ(result.y, doctest::Approx(expected.y).epsilon(1e-5));
+  CHECK_EQ(result.z, doctest::Approx(expected.z).epsilon(1e-5));
+}
+
+TEST_CASE("TransformAndShade float SIMD levels match scalar") {
+  const PointCloudf cloud = MakeTestCloud<float>(1003);
+  const ShadeParams params = MakeTestShadeParams();
+  std::vector<int32_t> cells(cloud.Size());
+  std::vector<double> depths(cloud.Size());
+  std::vector<uint8_t> glyphs(cloud.Size());
+
+  TransformAndShade(cloud, params, {cells, depths, glyphs}, kSimdScalar);
+
+  for (int level = kSimdSse2; level <= DetectSimdLevel(); ++level) {
+    std::vector<int32_t> simd_cells(cloud.Size());
+    std::vector<double> simd_depths(cloud.Size());
+    std::vector<uint8_t> simd_glyphs(cloud.Size());
+
+    TransformAndShade(cloud, 3, cloud.Size(), params,
+                      {simd_cells, simd_depths, simd_glyphs},
+                      (SimdLevel)level);
+
+    for (size_t i = 3; i < cloud.Size(); ++i) {
+      CHECK_EQ(simd_cells[i - 3], cells[i]);
+      CHECK_EQ(simd_depths[i - 3], depths[i]);
+      CHECK_EQ(simd_glyphs[i - 3], glyphs[i]);
+    }
+  }
+}
+
+TEST_CASE("TransformAndShade float stays close to double") {
+  const PointCloud cloud = MakeTestCloud(1003);
+  const PointCloudf cloudf = MakeTestCloud<float>(1003);
+  const ShadeParams params = MakeTestShadeParams();
+  std::vector<int32_t> cells(cloud.Size());
+  std::vector<double> depths(cloud.Size());
+  std::vector<uint8_t> glyphs(cloud.Size());
+  std::vector<int32_t> cellsf(cloud.Size());
+  std::vector<double> depthsf(cloud.Size());
+  std::vector<uint8_t> glyphsf(cloud.Size());
+
+  TransformAndShade(cloud, params, {cells, depths, glyphs});
+  TransformAndShade(cloudf, params, {cellsf, depthsf, glyphsf});
+
+  // only points right on a cell or light level border may differ
+  int cell_mismatches = 0;
+  int glyph_mismatches = 0;
+  for (size_t i = 0; i < cloud.Size(); ++i) {
+    cell_mismatches += cells[i] != cellsf[i];
+    glyph_mismatches += glyphs[i] != glyphsf[i];
+    CHECK_EQ(depthsf[i], doctest::Approx(depths[i]).epsilon(1e-5));
+  }
+  CHECK_LE(cell_mismatches, 3);
+  CHECK_LE(glyph_mismatches, 3);
+}
+
+TEST_CASE("Framebuffer depth test") {
+  Framebuffer frame(4, 3);
+
+  frame.PutAt(5, 0.5, 'a');
+  frame.PutAt(5, 0.25, 'b');
+  frame.PutAt(5, 0.5, 'c');
+  frame.PutAt(6, -1.0, 'd');
+
+  CHECK_EQ(frame.Chars()[5], 'a');
+  CHECK_EQ(frame.Depths()[5], doctest::Approx(0.5));
+  CHECK_EQ(frame.Chars()[6], ' ');
+
+  frame.Clear();
+
+  CHECK_EQ(frame.Chars()[5], ' ');
+  CHECK_EQ(frame.Depths()[5], doctest::Approx(0.0));
+}
+
+TEST_CASE("ThreadPool runs every task once") {
+  ThreadPool pool(4);
+  std::vector<std::atomic<int>> runs(100);
+
+  for (int batch = 0; batch < 3; ++batch) {
+    pool.ParallelFor(runs.size(), [&](int i) { runs[i]++; });
+  }
+
+  CHECK_EQ(pool.Size(), 4);
+  for (const std::atomic<int>& run : runs) {
+    CHECK_EQ(run.load(), 3);
+  }
+}
+
+TEST_CASE("ParallelRasterizer matches sequential puts") {
+  const PointCloud cloud = MakeTestCloud(20011);
+  const ShadeParams params = MakeTestShadeParams();
+  const char glyphs[] = ".,-_:;=+*#%@";
+  std::vector<int32_t> cells(cloud.Size());
+  std::vector<double> depths(cloud.Size());
+  std::vector<uint8_t> glyph_indices(cloud.Size());
+  Framebuffer expected(params.width, params.height);
+
+  TransformAndShade(cloud, params, {cells, depths, glyph_indices});
+  for (size_t i = 0; i < cloud.Size(); ++i) {
+    if (cells[i] >= 0) {
+      expected.PutAt(cells[i], depths[i], glyphs[glyph_indices[i]]);
+    }
+  }
+
+  ParallelRasterizer rasterizer(5);
+  Framebuffer frame(params.width, params.height);
+  // second frame checks that worker buffers are left clean
+  for (int frame_index = 0; frame_index < 2; ++frame_index) {
+    frame.Clear();
+    rasterizer.Rasterize(cloud, params, glyphs, frame);
+
+    for (int cell = 0; cell < frame.Size(); ++cell) {
+      CHECK_EQ(frame.Chars()[cell], expected.Chars()[cell]);
+      CHECK_EQ(frame.Depths()[cell], expected.Depths()[cell]);
+    }
+  }
+}
+
+TEST_CASE("TransformAndShade back-face culling") {
+  const PointCloud cloud = MakeTestCloud(1003);
+  ShadeParams params = MakeTestShadeParams();
+  std::vector<int32_t> cells(cloud.Size());
+  std::vector<double> depths(cloud.Size());
+  std::vector<uint8_t> glyphs(cloud.Size());
+
+  TransformAndShade(cloud, params, {cells, depths, glyphs}, kSimdScalar);
+
+  params.cull_back_faces = true;
+  for (LightingMode lighting : {kLightingWorldSpace, kLightingObjectSpace}) {
+    params.lighting = lighting;
+    for (int level = kSimdScalar; level <= DetectSimdLevel(); ++level) {
+      std::vector<int32_t> culled_cells(cloud.Size());
+      std::vector<double> culled_depths(cloud.Size());
+      std::vector<uint8_t> culled_glyphs(cloud.Size());
+
+      TransformAndShade(cloud, params,
+                        {culled_cells, culled_depths, culled_glyphs},
+                        (SimdLevel)level);
+
+      for (size_t i = 0; i < cloud.Size(); ++i) {
+        const bool back = (params.matrix * cloud.Normal(i)).z < 0;
+        const bool cull = cells[i] >= 0 && back;
+        CHECK_EQ(culled_cells[i], cull ? kCellCulled : cells[i]);
+        CHECK_EQ(culled_depths[i], depths[i]);
+        CHECK_EQ(culled_glyphs[i], glyphs[i]);
+      }
+    }
+  }
+}
+
+TEST_CASE("ParallelRasterizer back-face culling keeps torus self-occlusion") {
+  // dense enough for front faces to cover every cell, at precision 200
+  // back faces still show through
+  const PointCloud torus = MakeTestTorus(0.25, 0.2, 800);
+  ShadeParams params = MakeTestShadeParams();
+  const char glyphs[] = ".,-_:;=+*#%@";
+  std::vector<int32_t> cells(torus.Size());
+  std::vector<double> depths(torus.Size());
+  std::vector<uint8_t> glyph_indices(torus.Size());
+  Framebuffer front_faces(params.width, params.height);
+
+  // front faces still hide each other where the torus overlaps itself,
+  // so they have to go through the depth test like before
+  TransformAndShade(torus, params, {cells, depths, glyph_indices});
+  int64_t front = 0;
+  int occluded_front = 0;
+  for (size_t i = 0; i < torus.Size(); ++i) {
+    if (cells[i] >= 0 && (params.matrix * torus.Normal(i)).z >= 0) {
+      ++front;
+      occluded_front += front_faces.Depths()[cells[i]] > depths[i] + 0.1;
+      front_faces.PutAt(cells[i], depths[i], glyphs[glyph_indices[i]]);
+    }
+  }
+  CHECK_GT(occluded_front, 0);
+
+  ParallelRasterizer rasterizer(4);
+  Framebuffer expected(params.width, params.height);
+  rasterizer.Rasterize(torus, params, glyphs, expected);
+  const RasterCounters all = rasterizer.LastCounters();
+  params.cull_back_faces = true;
+  Framebuffer frame(params.width, params.height);
+  rasterizer.Rasterize(torus, params, glyphs, frame);
+  const RasterCounters culled = rasterizer.LastCounters();
+
+  for (int cell = 0; cell < frame.Size(); ++cell) {
+    CHECK_EQ(frame.Chars()[cell], expected.Chars()[cell]);
+    CHECK_EQ(frame.Depths()[cell], expected.Depths()[cell]);
+  }
+  CHECK_EQ(all.points, (int64_t)torus.Size());
+  CHECK_EQ(all.culled, 0);
+  CHECK_EQ(all.off_screen + all.drawn, all.points);
+  CHECK_EQ(culled.points, all.points);
+  CHECK_EQ(culled.off_screen, all.off_screen);
+  CHECK_EQ(culled.drawn, front);
+  CHECK_EQ(culled.culled + culled.drawn, all.drawn);
+  CHECK_GT(culled.culled, all.drawn / 3);
+}
+
+TEST_CASE("PackedFramebuffer packing orders by depth") {
+  CHECK_EQ(PackedFramebuffer::Pack(0.0, 'a'), 0);
+  CHECK_EQ(PackedFramebuffer::Pack(-0.5, 'a'), 0);
+  CHECK_GT(PackedFramebuffer::Pack(1e-9, 'a'), 0);
+  CHECK_LT(PackedFramebuffer::Pack(0.25, '@'),
+           PackedFramebuffer::Pack(0.5, '.'));
+  CHECK_EQ(PackedFramebuffer::Pack(5.0, 'a'),
+           PackedFramebuffer::Pack(1.0, 'a'));
+
+  const uint32_t word = PackedFramebuffer::Pack(0.75, '#');
+  CHECK_EQ(PackedFramebuffer::UnpackChar(word), '#');
+  CHECK_EQ(PackedFramebuffer::UnpackDepth(word),
+           doctest::Approx(0.75).epsilon(1e-6));
+}
+
+TEST_CASE("PackedFramebuffer depth test and resolve") {
+  PackedFramebuffer packed(4, 3);
+  Framebuffer frame(4, 3);
+
+  packed.PutAt(5, 0.5, 'a');
+  packed.PutAt(5, 0.25, 'b');
+  packed.PutAt(6, -1.0, 'd');
+  packed.Put(7, 'e');
+  packed.Resolve(frame);
+
+  CHECK_EQ(frame.Chars()[5], 'a');
+  CHECK_EQ(frame.Depths()[5], doctest::Approx(0.5).epsilon(1e-6));
+  CHECK_EQ(frame.Chars()[6], ' ');
+  CHECK_EQ(frame.Chars()[7], 'e');
+
+  packed.Clear();
+  packed.Resolve(frame);
+
+  CHECK_EQ(frame.Chars()[5], ' ');
+}
+
+TEST_CASE("PackedFramebuffer concurrent puts keep the closest") {
+  PackedFramebuffer packed(8, 8);
+  ThreadPool pool(4);
+
+  pool.ParallelFor(64, [&](int task) {
+    for (int cell = 0; cell < packed.Size(); ++cell) {
+      const double depth = ((task * 37 + cell * 11) % 64 + 1) / 128.0;
+      packed.PutAt(cell, depth, 'a' + task % 26);
+    }
+  });
+
+  for (int cell = 0; cell < packed.Size(); ++cell) {
+    CHECK_EQ(packed.At(cell) >> 8, PackedFramebuffer::Pack(0.5, 0) >> 8);
+  }
+}
+
+TEST_CASE("ParallelRasterizer into PackedFramebuffer matches single thread") {
+  const PointCloud cloud = MakeTestCloud(20011);
+  const ShadeParams params = MakeTestShadeParams();
+  const char glyphs[] = ".,-_:;=+*#%@";
+  PackedFramebuffer expected(params.width, params.height);
+  PackedFramebuffer packed(params.width, params.height);
+
+  ParallelRasterizer(1).Rasterize(cloud, params, glyphs, expected);
+  ParallelRasterizer(6).Rasterize(cloud, params, glyphs, packed);
+
+  for (int cell = 0; cell < packed.Size(); ++cell) {
+    CHECK_EQ(packed.At(cell), expected.At(cell));
+  }
+}
+
+TEST_CASE("EpochFramebuffer matches Framebuffer across frames") {
+  EpochFramebuffer epoch(4, 3);
+  Framebuffer frame(4, 3);
+  std::vector<char> chars(epoch.Size(), ' ');
+
+  for (int frame_index = 0; frame_index < 3; ++frame_index) {
+    epoch.Clear();
+    frame.Clear();
+    // every frame touches a different subset of cells
+    for (int i = 0; i < 20; ++i) {
+      const int cell = (i * 7 + frame_index * 5) % (epoch.Size() - 2);
+      const double depth = ((i * 13 + frame_index) % 9 - 2) / 8.0;
+      epoch.PutAt(cell, depth, 'a' + i);
+      frame.PutAt(cell, depth, 'a' + i);
+    }
+    epoch.Put(epoch.Size() - 1 - frame_index % 2, 'z');
+    frame.Put(frame.Size() - 1 - frame_index % 2, 'z');
+
+    epoch.ResolveChars(chars);
+    for (int cell = 0; cell < epoch.Size(); ++cell) {
+      CHECK_EQ(epoch.CharAt(cell), frame.Chars()[cell]);
+      CHECK_EQ(epoch.DepthAt(cell), frame.Depths()[cell]);
+      CHECK_EQ(chars[cell], frame.Chars()[cell]);
+    }
+  }
+
+  // an empty frame blanks what the last one put
+  epoch.Clear();
+  epoch.ResolveChars(chars);
+  CHECK_EQ(std::count(chars.begin(), chars.end(), ' '), epoch.Size());
+}
+
+TEST_CASE("ParallelRasterizer into EpochFramebuffer matches Framebuffer") {
+  const PointCloud cloud = MakeTestCloud(20011);
+  ShadeParams params = MakeTestShadeParams();
+  const char glyphs[] = ".,-_:;=+*#%@";
+  ParallelRasterizer rasterizer(3);
+  Framebuffer expected(params.width, params.height);
+  EpochFramebuffer epoch(params.width, params.height);
+  std::vector<char> chars(epoch.Size(), ' ');
+
+  // the second frame is rotated, so stale cells of the first have to vanish
+  for (int frame_index = 0; frame_index < 2; ++frame_index) {
+    expected.Clear();
+    epoch.Clear();
+    rasterizer.Rasterize(cloud, params, glyphs, expected);
+    rasterizer.Rasterize(cloud, params, glyphs, epoch);
+    epoch.ResolveChars(chars);
+
+    for (int cell = 0; cell < epoch.Size(); ++cell) {
+      CHECK_EQ(epoch.CharAt(cell), expected.Chars()[cell]);
+      CHECK_EQ(epoch.DepthAt(cell), expected.Depths()[cell]);
+      CHECK_EQ(chars[cell], expected.Chars()[cell]);
+    }
+    params.matrix = Rotation({0.3, 0.1, 0.2}, 0.7).Matrix() * params.matrix;
+  }
+}
+
+TEST_CASE("Presenter emits only changed spans") {
+  const int width = 40;
+  const int height = 5;
+  Presenter presenter(width, height);
+  std::string frame(width * height, ' ');
+
+  frame[3] = 'a';
+  CHECK_EQ(presenter.Present(frame), "\033[H" + frame);
+  CHECK_EQ(presenter.Present(frame), "");
+
+  frame[width + 2] = 'b';
+  CHECK_EQ(presenter.Present(frame), "\033[2;3Hb");
+
+  // a short unchanged gap is rewritten, a long one is skipped
+  frame[width + 2] = 'c';
+  frame[width + 4] = 'd';
+  frame[width + 30] = 'e';
+  CHECK_EQ(presenter.Present(frame), "\033[2;3Hc d\033[25Ce");
+
+  const PresentStats& stats = presenter.Stats();
+  CHECK_EQ(stats.frames, 4);
+  CHECK_EQ(stats.full_redraws, 1);
+  CHECK_EQ(stats.last_frame_bytes, 15);
+  CHECK_EQ(stats.total_bytes, 3 + width * height + 0 + 7 + 15);
+}
+
+TEST_CASE("Presenter falls back to a full redraw") {
+  const int width = 16;
+  const int height = 4;
+  Presenter presenter(width, height);
+  std::string frame(width * height, ' ');
+  presenter.Present(frame);
+
+  // every other cell changed costs more as spans than as a whole frame
+  for (int i = 0; i < width * height; i += 2) {
+    frame[i] = '#';
+  }
+  CHECK_EQ(presenter.Present(frame), "\033[H" + frame);
+  CHECK_EQ(presenter.Stats().full_redraws, 2);
+
+  presenter.Invalidate();
+  CHECK_EQ(presenter.Present(frame), "\033[H" + frame);
+}
+
+TEST_CASE("Presenter output reproduces the frames") {
+  const int width = 37;
+  const int height = 11;
+  Presenter presenter(width, height);
+  std::vector<char> screen(width * height, ' ');
+  std::string frame(width * height, ' ');
+
+  for (int frame_index = 0; frame_index < 50; ++frame_index) {
+    for (int i = 0; i < frame_index * 3 % 40; ++i) {
+      frame[(frame_index * 131 + i * i * 7) % frame.size()] =
+          'a' + (frame_index + i) % 26;
+    }
+    ApplyTerminalOutput(presenter.Present(frame), width, screen);
+    CHECK(std::string_view(screen.data(), screen.size()) == frame);
+  }
+}
+
+TEST_CASE("TerminalWriter sends a frame with one syscall") {
+  int fds[2];
+  REQUIRE_EQ(pipe(fds), 0);
+  TerminalWriter writer(fds[1], 64);
+
+  writer.Append("\033[H");
+  writer.Append("frame");
+  CHECK(writer.Flush());
+  const std::string_view parts[] = {"\033[2;3H", "", "ab"};
+  CHECK(writer.Write(parts));
+  CHECK_EQ(writer.Syscalls(), 2);
+  CHECK(writer.Buffered().empty());
+
+  char read_back[32] = {};
+  CHECK_EQ(read(fds[0], read_back, sizeof(read_back)), 16);
+  CHECK_EQ(std::string_view(read_back), "\033[Hframe\033[2;3Hab");
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST_CASE("TerminalWriter finishes partial writes on a non-blocking fd") {
+  int fds[2];
+  REQUIRE_EQ(pipe(fds), 0);
+  REQUIRE_EQ(fcntl(fds[1], F_SETFL, O_NONBLOCK), 0);
+  TerminalWriter writer(fds[1]);
+
+  // much bigger than the pipe, so writes come back partial or EAGAIN
+  std::string head(300000, 'h');
+  std::string tail(500000, 't');
+  for (size_t i = 0; i < head.size(); i += 1000) {
+    head[i] = 'a' + i % 26;
+  }
+  std::string received;
+  std::thread reader([&] {
+    char chunk[4096];
+    ssize_t size;
+    while ((size = read(fds[0], chunk, sizeof(chunk))) > 0) {
+      received.append(chunk, size);
+    }
+  });
+
+  const std::string_view parts[] = {head, tail};
+  CHECK(writer.Write(parts));
+  CHECK_GT(writer.Syscalls(), 1);
+  close(fds[1]);
+  reader.join();
+  close(fds[0]);
+
+  CHECK(received == head + tail);
+}
+
+TEST_CASE("TerminalWriter reports a closed reader") {
+  int fds[2];
+  REQUIRE_EQ(pipe(fds), 0);
+  close(fds[0]);
+  // writing to a pipe without readers raises SIGPIPE by default
+  signal(SIGPIPE, SIG_IGN);
+  TerminalWriter writer(fds[1]);
+
+  const Result result = writer.Write("frame");
+  CHECK_FALSE(result);
+  CHECK_EQ(result.error.core, kTerminalWriteFailed);
+  close(fds[1]);
+}
+
+TEST_CASE("FrameRing hands over the newest frame") {
+  FrameRing ring(4);
+  CHECK_FALSE(ring.TryAcquire());
+
+  std::ranges::fill(ring.Back(), 'a');
+  ring.Publish();
+  REQUIRE(ring.TryAcquire());
+  CHECK_EQ(std::string_view(ring.Front().data(), 4), "aaaa");
+  CHECK_FALSE(ring.TryAcquire());
+
+  // the consumer fell behind, 'b' is dropped
+  std::ranges::fill(ring.Back(), 'b');
+  ring.Publish();
+  std::ranges::fill(ring.Back(), 'c');
+  ring.Publish();
+  // the taken frame stays intact while the producer keeps going
+  CHECK_EQ(std::string_view(ring.Front().data(), 4), "aaaa");
+  REQUIRE(ring.TryAcquire());
+  CHECK_EQ(std::string_view(ring.Front().data(), 4), "cccc");
+  CHECK_EQ(ring.Published(), 3);
+  CHECK_EQ(ring.Dropped(), 1);
+
+  ring.Close();
+  CHECK_FALSE(ring.WaitAcquire());
+}
+
+TEST_CASE("FrameRing frames are not torn across threads") {
+  const int frame_size = 4096;
+  const int frame_count = 20000;
+  FrameRing ring(frame_size);
+
+  int64_t taken = 0;
+  int64_t torn = 0;
+  int64_t out_of_order = 0;
+  std::thread consumer([&] {
+    int last = -1;
+    while (ring.WaitAcquire()) {
+      const std::span<const char> frame = ring.Front();
+      const int index = (unsigned char)frame[0] | (unsigned char)frame[1] << 8 |
+                        (unsigned char)frame[2] << 16;
+      torn += std::ranges::any_of(frame.subspan(3), [&](char sym) {
+        return sym != (char)index;
+      });
+      out_of_order += index <= last;
+      last = index;
+      ++taken;
+    }
+  });
+
+  for (int i = 0; i < frame_count; ++i) {
+    std::span<char> frame = ring.Back();
+    frame[0] = i;
+    frame[1] = i >> 8;
+    frame[2] = i >> 16;
+    std::fill(frame.begin() + 3, frame.end(), (char)i);
+    ring.Publish();
+  }
+  ring.Close();
+  consumer.join();
+
+  CHECK_EQ(torn, 0);
+  CHECK_EQ(out_of_order, 0);
+  CHECK_GT(taken, 0);
+  CHECK_EQ(taken + ring.Dropped(), frame_count);
+}
+
+// moves a '#' one cell right every frame, optionally stops the renderer
+class StepHandler : public VulkanRenderHandler {
+ public:
+  explicit StepHandler(int stop_at = 0) : stop_at_(stop_at) {}
+
+  void Render(double delta, VulkanRenderer& renderer) override {
+    deltas_.push_back(delta);
+    renderer.BeginStage(kStageRaster);
+    renderer.Put(frames_ % renderer.GetWidth(), 1, '#');
+    if (++frames_ == stop_at_) {
+      renderer.Stop();
+    }
+  }
+
+  int64_t LastPointCount() const override { return 10; }
+
+  int Frames() const { return frames_; }
+  const std::vector<double>& Deltas() const { return deltas_; }
+
+ private:
+  int stop_at_;
+  int frames_ = 0;
+  std::vector<double> deltas_;
+};
+
+TEST_CASE("Headless VulkanRenderer renders frames into memory") {
+  for (const FramebufferMode mode :
+       {kFramebufferDepth, kFramebufferPacked, kFramebufferEpoch}) {
+    CAPTURE(mode);
+    StepHandler handler;
+    auto renderer = VulkanRenderer::New({
+        .width = 8,
+        .height = 3,
+        .max_frames = 5,
+        .backend = kBackendHeadless,
+        .framebuffer_mode = mode,
+        .render_handler = &handler,
+    });
+    REQUIRE(renderer);
+    std::unique_ptr<VulkanRenderer> owner(*renderer);
+
+    owner->Start();
+    CHECK_EQ(handler.Frames(), 5);
+    CHECK_EQ(owner->GetPresentStats().frames, 5);
+    const std::span<const char> frame = owner->GetPresentedFrame();
+    CHECK_EQ(std::string_view(frame.data(), frame.size()),
+             "        "
+             "    #   "
+             "        ");
+  }
+}
+
+TEST_CASE("Headless VulkanRenderer stops from the presenter thread mode") {
+  StepHandler handler(7);
+  MemorySink recording;
+  auto renderer = VulkanRenderer::New({
+      .width = 8,
+      .height = 3,
+      .backend = kBackendHeadless,
+      .recorder = &recording,
+      .present_mode = kPresentThread,
+      .render_handler = &handler,
+  });
+  REQUIRE(renderer);
+  std::unique_ptr<VulkanRenderer> owner(*renderer);
+
+  owner->Start();
+  CHECK_EQ(handler.Frames(), 7);
+  // the last frame is never dropped, Start waits for it
+  CHECK_EQ(owner->GetPresentStats().frames + owner->GetDroppedFrames(), 7);
+  // frames the presenter dropped are recorded all the same
+  CHECK_EQ(recording.FrameCount(), 7);
+  const std::span<const char> frame = owner->GetPresentedFrame();
+  CHECK_EQ(std::string_view(frame.data(), frame.size()),
+           "        "
+           "      # "
+           "        ");
+}
+
+TEST_CASE("LatencyHistogram buckets cover every value once") {
+  for (int bucket = 1; bucket < LatencyHistogram::kBucketCount; ++bucket) {
+    CHECK_EQ(LatencyHistogram::BucketBegin(bucket),
+             LatencyHistogram::BucketEnd(bucket - 1) + 1);
+  }
+  CHECK_EQ(LatencyHistogram::BucketEnd(LatencyHistogram::kBucketCount - 1),
+           LatencyHistogram::kMaxValue);
+  for (const int64_t value : {0L, 1L, 63L, 64L, 65L, 1000L, 123456789L,
+                              LatencyHistogram::kMaxValue}) {
+    const int bucket = LatencyHistogram::BucketOf(value);
+    CHECK_LE(LatencyHistogram::BucketBegin(bucket), value);
+    CHECK_GE(LatencyHistogram::BucketEnd(bucket), value);
+  }
+}
+
+TEST_CASE("LatencyHistogram percentiles") {
+  LatencyHistogram histogram;
+  CHECK_EQ(histogram.Percentile(99), 0);
+
+  // 1..10000 us
+  for (int64_t i = 1; i <= 10000; ++i) {
+    histogram.Record(i * 1000);
+  }
+  CHECK_EQ(histogram.Count(), 10000);
+  CHECK_EQ(histogram.Min(), 1000);
+  CHECK_EQ(histogram.Max(), 10000000);
+  CHECK_EQ(histogram.Mean(), doctest::Approx(5000500.0));
+  for (const double percent : {50.0, 95.0, 99.0, 99.9}) {
+    const double exact = percent * 100000;
+    CHECK_GE(histogram.Percentile(percent), exact);
+    CHECK_LE(histogram.Percentile(percent), exact * (1.0 + 1.0 / 32));
+  }
+  CHECK_EQ(histogram.Percentile(100), 10000000);
+
+  LatencyHistogram tail;
+  tail.Record(-5);
+  tail.Record(LatencyHistogram::kMaxValue + 1000);
+  CHECK_EQ(tail.Min(), 0);
+  CHECK_EQ(tail.Max(), LatencyHistogram::kMaxValue);
+
+  histogram.Merge(tail);
+  CHECK_EQ(histogram.Count(), 10002);
+  CHECK_EQ(histogram.Min(), 0);
+  CHECK_EQ(histogram.Percentile(100), LatencyHistogram::kMaxValue);
+}
+
+TEST_CASE("VulkanRenderer records every stage of every frame") {
+  const char* path = "frame_stats_test.csv";
+  StepHandler handler;
+  auto renderer = VulkanRenderer::New({
+      .width = 8,
+      .height = 3,
+      .target_fps = 1000,
+      .max_frames = 4,
+      .backend = kBackendHeadless,
+      .frame_stats_path = path,
+      .frame_stats_format = kStatsCsv,
+      .render_handler = &handler,
+  });
+  REQUIRE(renderer);
+  std::unique_ptr<VulkanRenderer> owner(*renderer);
+
+  owner->Start();
+  const FrameStats& stats = owner->GetFrameStats();
+  CHECK_EQ(stats.frames.Count(), 4);
+  for (const LatencyHistogram& stage : stats.stages) {
+    CHECK_EQ(stage.Count(), 4);
+  }
+  // paced at 1 ms a frame
+  CHECK_GT(stats.frames.Mean(), 900000.0);
+
+  std::ifstream file(path);
+  REQUIRE(file.is_open());
+  std::stringstream written;
+  written << file.rdbuf();
+  std::stringstream expected;
+  stats.Write(expected, kStatsCsv);
+  CHECK_EQ(written.str(), expected.str());
+  CHECK_NE(written.str().find("\nraster,4,"), std::string::npos);
+  std::remove(path);
+}
+
+TEST_CASE("FramePacer keeps to absolute deadlines") {
+  using namespace std::chrono_literals;
+  FramePacer pacer(2ms, 200us, kOverrunCatchUp);
+  const FramePacer::Clock::time_point begin = FramePacer::Clock::now();
+  pacer.Start(begin);
+
+  double seconds = 0.0;
+  for (int i = 0; i < 50; ++i) {
+    seconds += pacer.Wait();
+  }
+  const std::chrono::duration<double> elapsed =
+      FramePacer::Clock::now() - begin;
+
+  CHECK_GE(elapsed.count(), 0.1);
+  CHECK_EQ(seconds, doctest::Approx(elapsed.count()).epsilon(0.01));
+  // oversleeping a frame shortens the next one instead of adding up, unless
+  // the machine stalled for so long that the pacer started over
+  if (pacer.Stats().skipped == 0) {
+    CHECK_EQ(pacer.Deadline() - begin, 51 * 2ms);
+  }
+  CHECK_EQ(pacer.Stats().intervals.Count(), 50);
+  CHECK_EQ(pacer.Stats().wake_error.Count() + pacer.Stats().overruns, 50);
+}
+
+TEST_CASE("FramePacer overrun policies") {
+  using namespace std::chrono_literals;
+
+  SUBCASE("catch up") {
+    FramePacer pacer(2ms, 200us, kOverrunCatchUp);
+    const FramePacer::Clock::time_point begin = FramePacer::Clock::now();
+    pacer.Start(begin);
+    std::this_thread::sleep_for(5ms);
+
+    // the late frames run back to back until the schedule is met
+    for (int i = 0; i < 3; ++i) {
+      pacer.Wait();
+    }
+    CHECK_GE(FramePacer::Clock::now() - begin, 6ms);
+    CHECK_EQ(pacer.Deadline() - begin, 8ms);
+    CHECK_GE(pacer.Stats().overruns, 2);
+    CHECK_EQ(pacer.Stats().skipped, 0);
+  }
+
+  SUBCASE("skip") {
+    FramePacer pacer(2ms, 200us, kOverrunSkip);
+    const FramePacer::Clock::time_point begin = FramePacer::Clock::now();
+    pacer.Start(begin);
+    std::this_thread::sleep_for(5ms);
+
+    // waits for the next slot on the schedule
+    const double delta = pacer.Wait();
+    const std::chrono::nanoseconds slot = pacer.Deadline() - 2ms - begin;
+    CHECK_EQ(slot % 2ms, 0ns);
+    CHECK_GE(slot, 6ms);
+    CHECK_GE(delta, 0.006);
+    CHECK_EQ(pacer.Stats().overruns, 1);
+    CHECK_EQ(pacer.Stats().skipped, slot / 2ms - 1);
+  }
+
+  SUBCASE("too late to catch up") {
+    FramePacer pacer(2ms, 200us, kOverrunCatchUp);
+    const FramePacer::Clock::time_point begin = FramePacer::Clock::now();
+    pacer.Start(begin);
+    std::this_thread::sleep_for(12ms);
+
+    // starts a new schedule from now
+    pacer.Wait();
+    CHECK_GE(pacer.Stats().skipped, FramePacer::kMaxCatchUpFrames);
+    CHECK_GE(pacer.Deadline() - begin, 14ms);
+  }
+}
+
+TEST_CASE("VulkanRenderer batch renders at a fixed delta into a sink") {
+  StepHandler handler;
+  auto renderer = VulkanRenderer::New({
+      .width = 8,
+      .height = 3,
+      .target_fps = 1,
+      .backend = kBackendHeadless,
+      .render_handler = &handler,
+  });
+  REQUIRE(renderer);
+  std::unique_ptr<VulkanRenderer> owner(*renderer);
+
+  MemorySink memory(5 * 24);
+  const auto report =
+      owner->RenderBatch({.frames = 5, .delta = 0.25, .sink = &memory});
+  REQUIRE(report);
+  CHECK_EQ(report->frames, 5);
+  CHECK_EQ(report->points, 50);
+  CHECK_GT(report->FramesPerSecond(), 0.0);
+  CHECK_GT(report->NsPerPoint(), 0.0);
+  // nothing paced it to target_fps
+  CHECK_LT(report->elapsed, std::chrono::milliseconds(500));
+  CHECK(std::ranges::all_of(handler.Deltas(),
+                            [](double delta) { return delta == 0.25; }));
+  CHECK_EQ(owner->GetFrameStats().frames.Count(), 5);
+
+  REQUIRE_EQ(memory.FrameCount(), 5);
+  REQUIRE_EQ(memory.Frames().size(), 5 * 24);
+  for (int frame = 0; frame < 5; ++frame) {
+    const std::string_view row(memory.Frames().data() + frame * 24 + 8, 8);
+    CHECK_EQ(row.find('#'), (size_t)frame);
+    CHECK_EQ(std::ranges::count(row, '#'), 1);
+  }
+
+  const char* path = "batch_test.raw";
+  auto file = FileSink::New(path);
+  REQUIRE(file);
+  std::unique_ptr<FileSink> file_sink(*file);
+  REQUIRE(owner->RenderBatch(
+      {.frames = 5, .delta = 0.25, .sink = file_sink.get()}));
+  file_sink.reset();
+
+  std::ifstream written(path, std::ios::binary);
+  std::stringstream bytes;
+  bytes << written.rdbuf();
+  CHECK_EQ(bytes.str().size(), 5 * 24);
+  std::remove(path);
+
+  const auto missing = FileSink::New("no/such/directory/frames.raw");
+  REQUIRE_FALSE(missing);
+  CHECK_EQ(missing.error().kind, kFileError);
+}
+
+// frames of a few moving bars over a fixed background
+static std::vector<std::string> MakeTestFrames(int width,
+                                               int height,
+                                               int count) {
+  std::vector<std::string> frames;
+  for (int f = 0; f < count; ++f) {
+    std::string frame(width * height, '.');
+    for (int y = 0; y < height; ++y) {
+      const int x = (f * (y + 1)) % width;
+      frame[y * width + x] = '#';
+      frame[y * width + (x + 1) % width] = '@';
+    }
+    // an occasional big change
+    if (f % 37 == 5) {
+      std::fill(frame.begin(), frame.begin() + frame.size() / 2, '%');
+    }
+    frames.push_back(frame);
+  }
+  return frames;
+}
+
+TEST_CASE("FrameRecorder raw recordings play back frame by frame") {
+  const int width = 40;
+  const int height = 30;
+  const std::vector<std::string> frames = MakeTestFrames(width, height, 150);
+  std::size_t sizes[2] = {};
+
+  for (const RecordFormat format : {kRecordRaw, kRecordRawDelta}) {
+    CAPTURE(format);
+    const char* path = "recorder_test.rec";
+    auto recorder_exp = FrameRecorder::New(path, {
+                                                     .width = width,
+                                                     .height = height,
+                                                     .format = format,
+                                                     .keyframe_interval = 16,
+                                                     .frame_interval = 0.5,
+                                                     .chunk_size = 1,
+                                                 });
+    REQUIRE(recorder_exp);
+    std::unique_ptr<FrameRecorder> recorder(*recorder_exp);
+    for (const std::string& frame : frames) {
+      REQUIRE(recorder->Consume(frame));
+    }
+    REQUIRE(recorder->Finish());
+    sizes[format] = recorder->Size();
+
+    auto reader_exp = RecordingReader::New(path);
+    REQUIRE(reader_exp);
+    std::unique_ptr<RecordingReader> reader(*reader_exp);
+    CHECK_EQ(reader->GetWidth(), width);
+    CHECK_EQ(reader->GetHeight(), height);
+    REQUIRE_EQ(reader->FrameCount(), 150);
+
+    // random access, backwards
+    std::string frame(width * height, ' ');
+    for (int64_t i = 149; i >= 0; --i) {
+      REQUIRE(reader->ReadFrame(i, frame));
+      CHECK(frame == frames[i]);
+      CHECK_EQ(reader->FrameTimeNs(i), (uint64_t)i * 500000000);
+    }
+    CHECK_FALSE(reader->ReadFrame(150, frame));
+    std::remove(path);
+  }
+
+  CHECK_LT(sizes[kRecordRawDelta], sizes[kRecordRaw]);
+}
+
+TEST_CASE("FrameRecorder rejects frames of the wrong size") {
+  const int width = 8;
+  const int height = 4;
+  for (const RecordFormat format :
+       {kRecordRaw, kRecordRawDelta, kRecordAsciicast}) {
+    CAPTURE(format);
+    const char* path = "recorder_size_test.rec";
+    auto recorder_exp = FrameRecorder::New(path, {
+                                                     .width = width,
+                                                     .height = height,
+                                                     .format = format,
+                                                 });
+    REQUIRE(recorder_exp);
+    std::unique_ptr<FrameRecorder> recorder(*recorder_exp);
+
+    const std::string frame(width * height, '#');
+    const Result short_frame =
+        recorder->Consume(std::string_view(frame).substr(1));
+    CHECK_EQ(short_frame.error.core, kRecordingFailed);
+    const Result long_frame = recorder->Consume(frame + '#');
+    CHECK_EQ(long_frame.error.core, kRecordingFailed);
+    CHECK(recorder->Consume(frame));
+    CHECK_EQ(recorder->FrameCount(), 1);
+    REQUIRE(recorder->Finish());
+    std::remove(path);
+    std::remove((std::string(path) + ".idx").c_str());
+  }
+}
+
+TEST_CASE("FrameRecorder asciicast replays to the frames") {
+  const int width = 20;
+  const int height = 6;
+  const std::vector<std::string> frames = MakeTestFrames(width, height, 40);
+  const char* path = "recorder_test.cast";
+
+  auto recorder_exp = FrameRecorder::New(path, {
+                                                   .width = width,
+                                                   .height = height,
+                                                   .format = kRecordAsciicast,
+                                                   .keyframe_interval = 10,
+                                                   .frame_interval = 0.25,
+                                               });
+  REQUIRE(recorder_exp);
+  std::unique_ptr<FrameRecorder> recorder(*recorder_exp);
+  for (const std::string& frame : frames) {
+    REQUIRE(recorder->Consume(frame));
+  }
+  REQUIRE(recorder->Finish());
+  const std::vector<uint64_t> offsets = recorder->Offsets();
+
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream bytes;
+  bytes << file.rdbuf();
+  const std::string cast = bytes.str();
+  CHECK(cast.starts_with(
+      "{\"version\": 2, \"width\": 20, \"height\": 6}\n"));
+
+  std::vector<char> screen(width * height, ' ');
+  for (size_t i = 0; i < frames.size(); ++i) {
+    const size_t line_end = cast.find('\n', offsets[i]);
+    const std::string_view line(cast.data() + offsets[i],
+                                line_end - offsets[i]);
+    CHECK(line.starts_with("[" + std::to_string(i * 0.25).substr(0, 4)));
+
+    // JSON string of the event, unescaped
+    const size_t begin = line.find(", \"o\", \"") + 8;
+    std::string output;
+    for (size_t c = begin; c < line.size() - 2; ++c) {
+      if (line[c] != '\\') {
+        output += line[c];
+      } else if (line[c + 1] == 'u') {
+        output += (char)std::stoi(std::string(line.substr(c + 2, 4)), nullptr,
+                                  16);
+        c += 5;
+      } else {
+        output += line[++c];
+      }
+    }
+    if (i % 10 == 0) {
+      CHECK(output.starts_with("\033[H"));
+    }
+    ApplyTerminalOutput(output, width, screen);
+    CHECK(std::string_view(screen.data(), screen.size()) == frames[i]);
+  }
+
+  std::ifstream index(std::string(path) + ".idx", std::ios::binary);
+  uint64_t count = 0;
+  index.read((char*)&count, sizeof(count));
+  CHECK_EQ(count, frames.size());
+  std::remove(path);
+  std::remove((std::string(path) + ".idx").c_str());
+}
+
+TEST_CASE("FrameCache round trips frames") {
+  const std::vector<std::string> frames = MakeTestFrames(20, 6, 4);
+  FrameCache cache(1 << 20);
+  for (size_t i = 0; i < frames.size(); ++i) {
+    cache.Insert(i, frames[i]);
+  }
+
+  for (size_t i = 0; i < frames.size(); ++i) {
+    std::string out(frames[i].size(), '?');
+    REQUIRE(cache.Lookup(i, out));
+    CHECK_EQ(out, frames[i]);
+
+    std::string visited;
+    CHECK(cache.Visit(i, [&](int index, int length, char sym) {
+      CHECK_EQ((size_t)index, visited.size());
+      CHECK_GT(length, 0);
+      visited.append(length, sym);
+    }));
+    CHECK_EQ(visited, frames[i]);
+  }
+
+  std::string out(20 * 6, '?');
+  CHECK_FALSE(cache.Lookup(frames.size(), out));
+  CHECK_EQ(out, std::string(20 * 6, '?'));
+  CHECK_EQ(cache.Stats().hits, 8);
+  CHECK_EQ(cache.Stats().misses, 1);
+  CHECK_EQ(cache.Stats().entries, 4);
+
+  // long runs take more than one varint byte
+  const std::string blank(100000, ' ');
+  cache.Insert(0, blank);
+  std::string blank_out(blank.size(), '?');
+  REQUIRE(cache.Lookup(0, blank_out));
+  CHECK_EQ(blank_out, blank);
+}
+
+TEST_CASE("FrameCache evicts least recently used frames to its budget") {
+  const std::string frame(1000, ' ');
+  // a blank frame is one run of a char and a 2 byte length
+  const size_t entry_bytes = 3 + FrameCache::kEntryOverhead;
+  FrameCache cache(entry_bytes * 3);
+  std::string out(frame.size(), ' ');
+
+  cache.Insert(1, frame);
+  cache.Insert(2, frame);
+  cache.Insert(3, frame);
+  CHECK_EQ(cache.Stats().bytes, entry_bytes * 3);
+  REQUIRE(cache.Lookup(1, out));
+  cache.Insert(4, frame);
+  CHECK_EQ(cache.Stats().evictions, 1);
+  CHECK_EQ(cache.Stats().entries, 3);
+  CHECK_FALSE(cache.Lookup(2, out));
+  CHECK(cache.Lookup(1, out));
+  CHECK(cache.Lookup(3, out));
+  CHECK(cache.Lookup(4, out));
+
+  // replacing a frame doesn't count it twice
+  cache.Insert(4, frame);
+  CHECK_EQ(cache.Stats().entries, 3);
+  CHECK_EQ(cache.Stats().bytes, entry_bytes * 3);
+
+  cache.SetBudget(entry_bytes);
+  CHECK_EQ(cache.Stats().entries, 1);
+  CHECK(cache.Lookup(4, out));
+
+  // a frame bigger than the whole budget is not stored
+  std::string noise(1000, ' ');
+  for (size_t i = 0; i < noise.size(); i += 2) {
+    noise[i] = '#';
+  }
+  cache.Insert(5, noise);
+  CHECK_FALSE(cache.Lookup(5, out));
+  CHECK(cache.Lookup(4, out));
+
+  cache.Clear();
+  CHECK_EQ(cache.Stats().entries, 0);
+  CHECK_EQ(cache.Stats().bytes, 0);
+  CHECK_FALSE(cache.Lookup(4, out));
+}
+
+TEST_CASE("PointCloud and Framebuffer allocate from a memory resource") {
+  struct CountingResource : std::pmr::memory_resource {
+    size_t allocated = 0;
+
+    void* do_allocate(size_t size, size_t alignment) override {
+      allocated += size;
+      return std::pmr::new_delete_resource()->allocate(size, alignment);
+    }
+    void do_deallocate(void* ptr, size_t size, size_t alignment) override {
+      std::pmr::new_delete_resource()->deallocate(ptr, size, alignment);
+    }
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+      return this == &other;
+    }
+  };
+  CountingResource resource;
+
+  PointCloudf cloud(100, &resource);
+  CHECK_EQ(resource.allocated, 6 * 100 * sizeof(float));
+  for (const std::span<const float> array :
+       {cloud.X(), cloud.Y(), cloud.Z(), cloud.Nx(), cloud.Ny(), cloud.Nz()}) {
+    CHECK_EQ((uintptr_t)array.data() % PointCloudf::kAlignment, 0u);
+  }
+  // the arrays keep the resource when moved
+  PointCloudf moved(std::move(cloud));
+  moved.Resize(200);
+  CHECK_EQ(resource.allocated, 6 * 300 * sizeof(float));
+
+  resource.allocated = 0;
+  Framebuffer frame(4, 3, &resource);
+  CHECK_EQ(resource.allocated, 4 * 3 * (sizeof(char) + sizeof(double)));
+  frame.PutAt(5, 1.0, '#');
+  CHECK_EQ(frame.Chars()[5], '#');
+}